@@ -0,0 +1,74 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+#include "disjoint_mapped.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * restart of a service: the partition rebuilt by add and merge, against load of a saved file and a mapped view of it
+ * usage: archive_benchmark [keys] [merges] [queries]
+ */
+struct flat_index_policy : public icy::disjoint_policy {
+    using storage_policy = icy::index_storage;
+    using dictionary_policy = icy::flat_dictionary;
+};
+
+template <typename _Set> void run(const char* _kind, uint32_t _n, const std::vector<std::pair<uint32_t, uint32_t>>& _edges,
+    const std::vector<std::pair<uint32_t, uint32_t>>& _queries) {
+    char _name[64];
+    const auto _path = std::filesystem::temp_directory_path() / "icy_archive_benchmark.dsj";
+    size_t _hits = 0;
+    _Set _s;
+    snprintf(_name, sizeof(_name), "%s rebuild: add + merge", _kind);
+    icy_bench(_name, _n + _edges.size(), [&]() {
+        for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+        for (const auto& [_x, _y] : _edges) _s.merge(_x, _y);
+    });
+    snprintf(_name, sizeof(_name), "%s save(path)", _kind);
+    icy_bench(_name, _n, [&]() { _s.save(_path); });
+    printf("%s file: %zu bytes, %u keys in %zu classifications\n", _kind, static_cast<size_t>(std::filesystem::file_size(_path)), _n, _s.classification());
+    {
+        _Set _t;
+        snprintf(_name, sizeof(_name), "%s load(path)", _kind);
+        icy_bench(_name, _n, [&]() { _t = _Set::load(_path); });
+        snprintf(_name, sizeof(_name), "%s loaded: sibling(x, y)", _kind);
+        icy_bench(_name, _queries.size(), [&]() {
+            for (const auto& [_x, _y] : _queries) _hits += _t.sibling(_x, _y);
+        });
+    }
+    snprintf(_name, sizeof(_name), "%s rebuilt: sibling(x, y)", _kind);
+    icy_bench(_name, _queries.size(), [&]() {
+        for (const auto& [_x, _y] : _queries) _hits += _s.sibling(_x, _y);
+    });
+    {
+        std::unique_ptr<icy::mapped_disjoint_set<uint32_t>> _v;
+        snprintf(_name, sizeof(_name), "%s mapped_disjoint_set(path)", _kind);
+        icy_bench(_name, 1, [&]() { _v = std::make_unique<icy::mapped_disjoint_set<uint32_t>>(_path); });
+        snprintf(_name, sizeof(_name), "%s mapped: sibling(x, y)", _kind);
+        icy_bench(_name, _queries.size(), [&]() {
+            for (const auto& [_x, _y] : _queries) _hits += _v->sibling(_x, _y);
+        });
+    }
+    std::filesystem::remove(_path);
+    icy_keep(_hits);
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 2000000);
+    const uint32_t _m = icy_arg(_argc, _argv, 2, 2000000);
+    const uint32_t _q = icy_arg(_argc, _argv, 3, 2000000);
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> _edges(_m), _queries(_q);
+    for (auto& _e : _edges) _e = {_key(_gen), _key(_gen)};
+    for (auto& _e : _queries) _e = {_key(_gen), _key(_gen)};
+    run<icy::disjoint_set<uint32_t>>("hash/pointer", _n, _edges, _queries);
+    run<icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, flat_index_policy>>("flat/index", _n, _edges, _queries);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * random sibling queries on a set far larger than the cache, one by one and interleaved by `sibling_batch`
+ * usage: batch_query_benchmark [keys] [queries]
+ */
+struct flat_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+};
+struct dense_pool_policy : public icy::dense_policy {
+    using storage_policy = icy::pool_storage;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, _Policy>;
+
+template <typename _Set> void run(const char* _kind, uint32_t _n, const std::vector<std::pair<uint32_t, uint32_t>>& _pairs) {
+    char _name[64];
+    _Set _s;
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+    for (uint32_t _i = 0; _i != _n / 2; ++_i) _s.merge(_key(_gen), _key(_gen));
+    // the queries compress the paths, each way runs on its own copy of the same forest
+    _Set _t = _s;
+    std::vector<bool> _out;
+    _out.reserve(_pairs.size());
+    snprintf(_name, sizeof(_name), "%s sibling(x, y)", _kind);
+    icy_bench(_name, _pairs.size(), [&]() {
+        for (const auto& [_x, _y] : _pairs) _out.push_back(_s.sibling(_x, _y));
+    });
+    icy_keep(_out);
+    _out.clear();
+    snprintf(_name, sizeof(_name), "%s sibling_batch(pairs)", _kind);
+    icy_bench(_name, _pairs.size(), [&]() { _t.sibling_batch(_pairs, std::back_inserter(_out)); });
+    icy_keep(_out);
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 4000000);
+    const uint32_t _m = icy_arg(_argc, _argv, 2, 4000000);
+    std::mt19937 _gen(_m);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> _pairs(_m);
+    for (auto& _p : _pairs) _p = {_key(_gen), _key(_gen)};
+    run<icy::disjoint_set<uint32_t>>("hash/pointer", _n, _pairs);
+    run<set_type<flat_policy>>("flat/index", _n, _pairs);
+    run<set_type<dense_pool_policy>>("dense/pool", _n, _pairs);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * cost of the change feed on the writer: adds, merges and joins without a feed, with a feed drained by a consumer thread,
+ * and with a feed nobody drains so that the changes find the ring full
+ * usage: change_feed_benchmark [keys] [merges]
+ */
+struct ring_policy : public icy::disjoint_policy {
+    using feed_policy = icy::ring_feed<1 << 16>;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, _Policy>;
+
+template <typename _Set> void run(const char* _kind, uint32_t _n, const std::vector<std::pair<uint32_t, uint32_t>>& _edges, bool _drain) {
+    char _name[64];
+    _Set _s;
+    std::atomic<bool> _done {false};
+    size_t _seen = 0;
+    std::thread _consumer;
+    if constexpr (_Set::feeding) {
+        if (_drain) _consumer = std::thread([&]() {
+            for (bool _last = false; !_last;) {
+                _last = _done.load(std::memory_order_acquire);
+                for (typename _Set::change_type _c; _s.poll(_c);) ++_seen;
+            }
+        });
+    }
+    snprintf(_name, sizeof(_name), "%s add", _kind);
+    icy_bench(_name, _n, [&]() {
+        for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+    });
+    snprintf(_name, sizeof(_name), "%s merge", _kind);
+    icy_bench(_name, _edges.size(), [&]() {
+        for (const auto& [_x, _y] : _edges) _s.merge(_x, _y);
+    });
+    snprintf(_name, sizeof(_name), "%s join(x, y)", _kind);
+    icy_bench(_name, _edges.size(), [&]() {
+        for (const auto& [_x, _y] : _edges) _s.join(_y, _x);
+    });
+    _done.store(true, std::memory_order_release);
+    if (_consumer.joinable()) _consumer.join();
+    icy_keep(_seen + _s.classification());
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 1000000);
+    const uint32_t _m = icy_arg(_argc, _argv, 2, 1000000);
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> _edges(_m);
+    for (auto& _e : _edges) _e = {_key(_gen), _key(_gen)};
+    run<icy::disjoint_set<uint32_t>>("no feed:", _n, _edges, false);
+    run<set_type<ring_policy>>("feed, drained:", _n, _edges, true);
+    run<set_type<ring_policy>>("feed, full:", _n, _edges, false);
+    return 0;
+}
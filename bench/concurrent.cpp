@@ -0,0 +1,66 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * scaling of the concurrent disjoint set, every thread runs its share of a stream of merges and sibling queries
+ * usage: concurrent_benchmark [keys] [operations] [max threads] [merge percent]
+ * the threads double from 1 up to max threads, 0 for all hardware threads
+ */
+struct flat_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+};
+template <typename _Policy> using concurrent_type = icy::concurrent_disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, _Policy>;
+
+struct operation {
+    uint32_t _x, _y;
+    bool _merge;
+};
+
+template <typename _Policy> void run(const char* _kind, const std::vector<uint32_t>& _keys, const std::vector<operation>& _ops, unsigned _threads) {
+    char _name[64];
+    for (unsigned _t = 1; _t <= _threads; _t *= 2) {
+        concurrent_type<_Policy> _s(_keys);
+        snprintf(_name, sizeof(_name), "%s %u threads", _kind, _t);
+        icy_bench(_name, _ops.size(), [&]() {
+            std::vector<std::jthread> _workers;
+            for (unsigned _i = 0; _i != _t; ++_i) {
+                _workers.emplace_back([&, _i]() {
+                    size_t _hits = 0;
+                    for (size_t _j = _ops.size() * _i / _t, _end = _ops.size() * (_i + 1) / _t; _j != _end; ++_j) {
+                        const operation& _op = _ops[_j];
+                        if (_op._merge) _s.merge(_op._x, _op._y);
+                        else _hits += _s.sibling(_op._x, _op._y);
+                    }
+                    icy_keep(_hits);
+                });
+            }
+        });
+        icy_keep(_s.classification());
+    }
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 4000000);
+    const uint32_t _m = icy_arg(_argc, _argv, 2, 8000000);
+    const unsigned _max = icy_arg(_argc, _argv, 3, 0);
+    const uint32_t _merges = icy_arg(_argc, _argv, 4, 20);
+    const unsigned _threads = _max == 0 ? std::max(1u, std::thread::hardware_concurrency()) : _max;
+    std::mt19937 _gen(_m);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::uniform_int_distribution<uint32_t> _percent(0, 99);
+    std::vector<uint32_t> _keys(_n);
+    for (uint32_t _i = 0; _i != _n; ++_i) _keys[_i] = _i;
+    std::vector<operation> _ops(_m);
+    for (auto& _op : _ops) _op = {_key(_gen), _key(_gen), _percent(_gen) < _merges};
+    run<icy::dense_policy>("dense", _keys, _ops, _threads);
+    run<flat_policy>("flat", _keys, _ops, _threads);
+    run<icy::disjoint_policy>("hash", _keys, _ops, _threads);
+    return 0;
+}
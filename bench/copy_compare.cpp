@@ -0,0 +1,37 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <random>
+
+/**
+ * copy construction and comparison, at several ratios of classifications to keys
+ * usage: copy_compare_benchmark [keys]
+ */
+using set_type = icy::disjoint_set<uint32_t>;
+
+void run(uint32_t _n, uint32_t _classes) {
+    char _name[64];
+    std::mt19937 _gen(_n ^ _classes);
+    std::uniform_int_distribution<uint32_t> _class(0, _classes - 1);
+    set_type _s;
+    for (uint32_t _i = 0; _i != _classes; ++_i) _s.add(_i);
+    for (uint32_t _i = _classes; _i != _n; ++_i) _s.add(_i, _class(_gen));
+    snprintf(_name, sizeof(_name), "%u classes, copy", _classes);
+    set_type* _copy = nullptr;
+    icy_bench(_name, _n, [&]() { _copy = new set_type(_s); });
+    snprintf(_name, sizeof(_name), "%u classes, operator==", _classes);
+    bool _equal = false;
+    icy_bench(_name, _n, [&]() { _equal = (*_copy == _s); });
+    if (!_equal) printf("copy differs from its source\n");
+    delete _copy;
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 1000000);
+    for (uint32_t _ratio = 1000; _ratio >= 1; _ratio /= 10) {
+        run(_n, _n / _ratio);
+    }
+    return 0;
+}
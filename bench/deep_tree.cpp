@@ -0,0 +1,106 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <string>
+
+/**
+ * keep the trees deep on purpose: every merge hangs the old chain under a new header,
+ * and lookups only move the queried node
+ * besides the time, count the writes of the node counters: a counter that stores through `++`, `--`, `+=` and `-=`
+ * is plugged in by the storage policy, and set against the writes of the former scheme, one per ancestor header
+ * usage: deep_tree_benchmark [leaves]
+ */
+struct counted_size {
+    static inline size_t writes = 0;
+    counted_size() = default;
+    counted_size(size_t _v) : _v(_v) {}
+    operator size_t() const { return _v; }
+    counted_size& operator++() { ++writes; ++_v; return *this; }
+    counted_size& operator--() { ++writes; --_v; return *this; }
+    counted_size& operator+=(size_t _n) { ++writes; _v += _n; return *this; }
+    counted_size& operator-=(size_t _n) { ++writes; _v -= _n; return *this; }
+    size_t _v = 0;
+};
+struct counted_storage : public icy::pointer_storage {
+    using size_type = counted_size;
+};
+struct deep_policy : public icy::disjoint_policy {
+    using merge_policy = icy::merge_by_order;
+    using compress_policy = icy::compress_node;
+    using storage_policy = counted_storage;
+};
+struct shallow_policy : public icy::disjoint_policy {
+    using storage_policy = counted_storage;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+
+/**
+ * @brief build a chain of `_depth` headers, the deepest header holds `_leaves` keys
+ * @details keys [0, _leaves) are in the deepest header, keys [_leaves, _leaves + _depth) keep the chain alive
+ */
+template <typename _Set> void build(_Set& _s, unsigned _depth, unsigned _leaves) {
+    _s.add(0u);
+    for (unsigned _i = 1; _i != _leaves; ++_i) _s.add(_i, 0u);
+    _s.add(_leaves, 0u);
+    for (unsigned _i = 1; _i != _depth; ++_i) {
+        _s.add(_leaves + _i);
+        _s.add(_leaves + _depth + _i, _leaves + _i);
+        _s.merge(_leaves + _i, _leaves + _i - 1);
+    }
+}
+
+/**
+ * @brief time `_f` over the leaves, and print the counter writes per leaf next to @c _ancestors writes per leaf
+ */
+template <typename _Fn> void run(const char* _name, unsigned _leaves, size_t _ancestors, const _Fn& _f) {
+    counted_size::writes = 0;
+    icy_bench(_name, _leaves, _f);
+    printf("%-48s %12.2f counter writes/op, %zu by the former scheme\n", "", double(counted_size::writes) / _leaves, _ancestors);
+}
+
+/**
+ * @param _deep whether the leaves stay in the deepest header, or the class of the leaves absorbs the chain
+ */
+template <typename _Policy> void cases(const char* _kind, unsigned _depth, unsigned _leaves, bool _deep) {
+    char _name[64];
+    size_t _height, _ancestors;
+    {
+        set_type<_Policy> _s; build(_s, _depth, _leaves);
+        _height = _s.height();
+        // the headers from the one holding a leaf up to the root
+        _ancestors = _deep ? _height : 1;
+        snprintf(_name, sizeof(_name), "%s sibling(k), height %zu", _kind, _height);
+        // the former scheme decremented every header above a node moved to the root, and incremented the root
+        const bool _moved = _Policy::compress_policy::node && _ancestors > 1;
+        run(_name, _leaves, _moved ? _ancestors + 1 : 0, [&]() {
+            size_t _sum = 0;
+            for (unsigned _i = 0; _i != _leaves; ++_i) _sum += _s.sibling(_i);
+            icy_keep(_sum);
+        });
+    }
+    {
+        set_type<_Policy> _s; build(_s, _depth, _leaves);
+        snprintf(_name, sizeof(_name), "%s join(k), height %zu", _kind, _height);
+        // every header above the node, then the new root
+        run(_name, _leaves, _ancestors + 1, [&]() {
+            for (unsigned _i = 0; _i != _leaves; ++_i) _s.join(_i);
+        });
+    }
+    {
+        set_type<_Policy> _s; build(_s, _depth, _leaves);
+        snprintf(_name, sizeof(_name), "%s del(k), height %zu", _kind, _height);
+        run(_name, _leaves, _ancestors, [&]() {
+            for (unsigned _i = 0; _i != _leaves; ++_i) _s.del(_i);
+        });
+    }
+}
+
+int main(int _argc, char** _argv) {
+    const unsigned _leaves = icy_arg(_argc, _argv, 1, 1ul << 16);
+    for (unsigned _depth : {16u, 256u, 1024u, 4096u}) {
+        cases<deep_policy>("by order, compress node:", _depth, _leaves, true);
+        cases<shallow_policy>("by size, compress path:", _depth, _leaves, false);
+    }
+    return 0;
+}
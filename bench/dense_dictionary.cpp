@@ -0,0 +1,55 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * dense integer keys: the hash dictionary against the flat array dictionary
+ * usage: dense_dictionary_benchmark [keys] [merges] [case]
+ * case 0 runs all of them in one process, 1, 2, 3 run a single one on a fresh heap
+ */
+struct dense_index_policy : public icy::dense_policy {
+    using storage_policy = icy::index_storage;
+};
+using hash_set = icy::disjoint_set<uint32_t>;
+using dense_set = icy::dense_disjoint_set<uint32_t>;
+using dense_index_set = icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, dense_index_policy>;
+
+template <typename _Set> void run(const char* _kind, uint32_t _n, const std::vector<uint32_t>& _pairs) {
+    char _name[64];
+    _Set _s;
+    snprintf(_name, sizeof(_name), "%s add(k)", _kind);
+    icy_bench(_name, _n, [&]() {
+        for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+    });
+    const size_t _m = _pairs.size() / 2;
+    snprintf(_name, sizeof(_name), "%s merge(x, y), random", _kind);
+    icy_bench(_name, _m, [&]() {
+        for (size_t _i = 0; _i != _m; ++_i) _s.merge(_pairs[2 * _i], _pairs[2 * _i + 1]);
+    });
+    snprintf(_name, sizeof(_name), "%s sibling(x, y), random", _kind);
+    icy_bench(_name, _m, [&]() {
+        size_t _sum = 0;
+        for (size_t _i = 0; _i != _m; ++_i) _sum += _s.sibling(_pairs[2 * _i + 1], _pairs[2 * _i]);
+        icy_keep(_sum);
+    });
+    snprintf(_name, sizeof(_name), "%s clear()", _kind);
+    icy_bench(_name, _n, [&]() { _s.clear(); });
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 10000000);
+    const size_t _m = icy_arg(_argc, _argv, 2, _n / 2);
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::vector<uint32_t> _pairs(2 * _m);
+    for (auto& _k : _pairs) _k = _key(_gen);
+    const size_t _case = icy_arg(_argc, _argv, 3, 0);
+    if (_case == 0 || _case == 1) run<hash_set>("hash", _n, _pairs);
+    if (_case == 0 || _case == 2) run<dense_set>("dense", _n, _pairs);
+    if (_case == 0 || _case == 3) run<dense_index_set>("dense+index", _n, _pairs);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * building a partition from an edge list: add and merge one at a time against the bulk builder
+ * usage: from_edges_benchmark [keys] [edges] [threads]
+ */
+using set_type = icy::disjoint_set<uint32_t>;
+using dense_set = icy::dense_disjoint_set<uint32_t>;
+
+template <typename _Set> void run(const char* _kind, const std::vector<uint32_t>& _keys, const std::vector<std::pair<uint32_t, uint32_t>>& _edges, unsigned _threads) {
+    char _name[64];
+    {
+        _Set _s;
+        snprintf(_name, sizeof(_name), "%s add(k) + merge(x, y)", _kind);
+        icy_bench(_name, _edges.size(), [&]() {
+            for (uint32_t _k : _keys) _s.add(_k);
+            for (const auto& [_x, _y] : _edges) _s.merge(_x, _y);
+        });
+        icy_keep(_s);
+    }
+    for (unsigned _t : {1u, _threads}) {
+        snprintf(_name, sizeof(_name), "%s from_edges, %u threads", _kind, _t);
+        icy_bench(_name, _edges.size(), [&]() {
+            _Set _s = _Set::from_edges(_keys, _edges, _t);
+            icy_keep(_s);
+        });
+    }
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 2000000);
+    const size_t _m = icy_arg(_argc, _argv, 2, 4000000);
+    const unsigned _threads = icy_arg(_argc, _argv, 3, std::thread::hardware_concurrency());
+    std::vector<uint32_t> _keys(_n);
+    std::iota(_keys.begin(), _keys.end(), 0);
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> _edges(_m);
+    for (auto& _e : _edges) _e = {_key(_gen), _key(_gen)};
+    run<set_type>("hash", _keys, _edges, _threads);
+    run<dense_set>("dense", _keys, _edges, _threads);
+    return 0;
+}
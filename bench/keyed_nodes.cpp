@@ -0,0 +1,44 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * deleting small classifications from a large set, with and without key handles in the nodes
+ * usage: keyed_nodes_benchmark [keys] [deletions]
+ */
+struct keyed_policy : public icy::disjoint_policy {
+    using key_policy = icy::keyed_nodes;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, _Policy>;
+
+template <typename _Set> void run(const char* _kind, uint32_t _n, uint32_t _m) {
+    char _name[64];
+    _Set _s;
+    snprintf(_name, sizeof(_name), "%s add(k), classes of 4", _kind);
+    icy_bench(_name, _n, [&]() {
+        for (uint32_t _i = 0; _i != _n; ++_i) {
+            if (_i % 4 == 0) _s.add(_i);
+            else _s.add(_i, _i - _i % 4);
+        }
+    });
+    snprintf(_name, sizeof(_name), "%s del_except(k)", _kind);
+    icy_bench(_name, _m, [&]() {
+        for (uint32_t _i = 0; _i != _m; ++_i) _s.del_except(_i * 8);
+    });
+    snprintf(_name, sizeof(_name), "%s del_all(k)", _kind);
+    icy_bench(_name, _m, [&]() {
+        for (uint32_t _i = 0; _i != _m; ++_i) _s.del_all(_i * 8 + 4);
+    });
+    icy_keep(_s);
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 1000000);
+    const uint32_t _m = std::min<uint32_t>(icy_arg(_argc, _argv, 2, 100), _n / 8);
+    run<set_type<icy::disjoint_policy>>("unkeyed", _n, _m);
+    run<set_type<keyed_policy>>("keyed", _n, _m);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+
+#include <chrono>
+
+namespace {
+/**
+ * @brief run `_f` once and print the elapsed time in total and per operation
+ * @param _name the name of the case
+ * @param _ops the number of operations performed by `_f`
+ * @return elapsed milliseconds
+ */
+template <typename _Fn> double icy_bench(const char* _name, std::size_t _ops, const _Fn& _f) {
+    const auto _start = std::chrono::steady_clock::now();
+    _f();
+    const auto _end = std::chrono::steady_clock::now();
+    const double _ms = std::chrono::duration<double, std::milli>(_end - _start).count();
+    printf("%-48s %12.3f ms %12.2f ns/op\n", _name, _ms, _ms * 1e6 / (_ops == 0 ? 1 : _ops));
+    return _ms;
+}
+/**
+ * @brief read a size from argv, or return the default value
+ */
+std::size_t icy_arg(int _argc, char** _argv, int _i, std::size_t _default) {
+    if (_i < _argc) return static_cast<std::size_t>(std::strtoull(_argv[_i], nullptr, 10));
+    return _default;
+}
+/**
+ * @brief keep the optimizer from discarding `_v`
+ */
+template <typename _Tp> void icy_keep(const _Tp& _v) {
+    asm volatile("" : : "g"(&_v) : "memory");
+}
+}
@@ -0,0 +1,53 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * a skewed edge stream, a share of the edges touches a few hot hub keys, merged pair by pair and by `merge_batch`
+ * usage: merge_batch_benchmark [keys] [edges] [hub percent]
+ */
+struct flat_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+};
+struct dense_pool_policy : public icy::dense_policy {
+    using storage_policy = icy::pool_storage;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, _Policy>;
+
+template <typename _Set> void run(const char* _kind, uint32_t _n, const std::vector<std::pair<uint32_t, uint32_t>>& _edges) {
+    char _name[64];
+    _Set _s;
+    for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+    _Set _t = _s;
+    snprintf(_name, sizeof(_name), "%s merge(x, y)", _kind);
+    icy_bench(_name, _edges.size(), [&]() {
+        for (const auto& [_x, _y] : _edges) _s.merge(_x, _y);
+    });
+    snprintf(_name, sizeof(_name), "%s merge_batch(edges)", _kind);
+    icy_bench(_name, _edges.size(), [&]() { _t.merge_batch(_edges); });
+    if (_s.classification() != _t.classification()) printf("%s: classifications differ\n", _kind);
+    icy_keep(_s);
+    icy_keep(_t);
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 2000000);
+    const uint32_t _m = icy_arg(_argc, _argv, 2, 2000000);
+    const uint32_t _hot = icy_arg(_argc, _argv, 3, 50);
+    std::mt19937 _gen(_m);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::uniform_int_distribution<uint32_t> _hub(0, 7);
+    std::uniform_int_distribution<uint32_t> _percent(0, 99);
+    std::vector<std::pair<uint32_t, uint32_t>> _edges(_m);
+    for (auto& _e : _edges) _e = {_percent(_gen) < _hot ? _hub(_gen) : _key(_gen), _key(_gen)};
+    run<icy::disjoint_set<uint32_t>>("hash/pointer", _n, _edges);
+    run<set_type<flat_policy>>("flat/index", _n, _edges);
+    run<set_type<dense_pool_policy>>("dense/pool", _n, _edges);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * versions of a partition: random merges with a snapshot every few of them, then point-in-time queries of random versions,
+ * by a `persistent_disjoint_set` against a full copy of `disjoint_set` per version
+ * usage: persistent_benchmark [keys] [versions] [merges per version] [queries]
+ */
+template <typename _Fn> void versions(uint32_t _v, uint32_t _k, const std::vector<std::pair<uint32_t, uint32_t>>& _edges, const _Fn& _snapshot) {
+    for (uint32_t _i = 0; _i != _v; ++_i) {
+        _snapshot(_edges.data() + static_cast<size_t>(_i) * _k, _edges.data() + static_cast<size_t>(_i + 1) * _k);
+    }
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 100000);
+    const uint32_t _v = icy_arg(_argc, _argv, 2, 200);
+    const uint32_t _k = icy_arg(_argc, _argv, 3, 200);
+    const uint32_t _q = icy_arg(_argc, _argv, 4, 1000000);
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::uniform_int_distribution<uint32_t> _version(0, _v - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> _edges(static_cast<size_t>(_v) * _k);
+    for (auto& _e : _edges) _e = {_key(_gen), _key(_gen)};
+    std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>> _queries(_q);
+    for (auto& _e : _queries) _e = {_version(_gen), {_key(_gen), _key(_gen)}};
+    size_t _hits = 0;
+    {
+        icy::persistent_disjoint_set<uint32_t> _s;
+        icy_bench("persistent: add", _n, [&]() {
+            for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+        });
+        icy_bench("persistent: merges + snapshot()", _edges.size(), [&]() {
+            versions(_v, _k, _edges, [&](const auto* _first, const auto* _last) {
+                for (; _first != _last; ++_first) _s.merge(_first->first, _first->second);
+                _s.snapshot();
+            });
+        });
+        icy_bench("persistent: at(v).sibling(x, y)", _q, [&]() {
+            for (const auto& [_i, _e] : _queries) _hits += _s.at(_i).sibling(_e.first, _e.second);
+        });
+        icy_bench("persistent: sibling(x, y) latest", _q, [&]() {
+            for (const auto& [_i, _e] : _queries) _hits += _s.sibling(_e.first, _e.second);
+        });
+    }
+    {
+        icy::disjoint_set<uint32_t> _s;
+        std::vector<icy::disjoint_set<uint32_t>> _copies;
+        _copies.reserve(_v);
+        for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+        icy_bench("copies: merges + copy", _edges.size(), [&]() {
+            versions(_v, _k, _edges, [&](const auto* _first, const auto* _last) {
+                for (; _first != _last; ++_first) _s.merge(_first->first, _first->second);
+                _copies.push_back(_s);
+            });
+        });
+        icy_bench("copies: copies[v].sibling(x, y)", _q, [&]() {
+            for (const auto& [_i, _e] : _queries) _hits += _copies[_i].sibling(_e.first, _e.second);
+        });
+        printf("copies: %zu nodes kept for %u versions of %u keys\n", static_cast<size_t>(_v) * _n, _v, _n);
+    }
+    icy_keep(_hits);
+    return 0;
+}
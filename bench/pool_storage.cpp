@@ -0,0 +1,59 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * allocation-heavy workload: per-object allocation against pooled and slab storage
+ * usage: pool_storage_benchmark [keys] [case]
+ * case 0 runs all of them in one process, 1, 2, 3 run a single one on a fresh heap
+ */
+struct pool_policy : public icy::dense_policy {
+    using storage_policy = icy::pool_storage;
+};
+struct index_policy : public icy::dense_policy {
+    using storage_policy = icy::index_storage;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, _Policy>;
+
+template <typename _Set> void run(const char* _kind, uint32_t _n, const std::vector<uint32_t>& _keys) {
+    char _name[64];
+    _Set _s;
+    snprintf(_name, sizeof(_name), "%s add(k)", _kind);
+    icy_bench(_name, _n, [&]() {
+        for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+    });
+    snprintf(_name, sizeof(_name), "%s merge(x, y), random", _kind);
+    icy_bench(_name, _n, [&]() {
+        for (uint32_t _i = 0; _i != _n; ++_i) _s.merge(_keys[_i], _i);
+    });
+    snprintf(_name, sizeof(_name), "%s join(k), random", _kind);
+    icy_bench(_name, _n, [&]() {
+        for (uint32_t _k : _keys) _s.join(_k);
+    });
+    snprintf(_name, sizeof(_name), "%s del(k) + add(k, target)", _kind);
+    icy_bench(_name, _n, [&]() {
+        for (uint32_t _i = 0; _i != _n; ++_i) {
+            _s.del(_keys[_i]);
+            _s.add(_keys[_i], _i);
+        }
+    });
+    snprintf(_name, sizeof(_name), "%s clear()", _kind);
+    icy_bench(_name, _n, [&]() { _s.clear(); });
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 4000000);
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::vector<uint32_t> _keys(_n);
+    for (auto& _k : _keys) _k = _key(_gen);
+    const size_t _case = icy_arg(_argc, _argv, 2, 0);
+    if (_case == 0 || _case == 1) run<set_type<icy::dense_policy>>("pointer", _n, _keys);
+    if (_case == 0 || _case == 2) run<set_type<pool_policy>>("pool", _n, _keys);
+    if (_case == 0 || _case == 3) run<set_type<index_policy>>("index", _n, _keys);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * bulk load with and without reserve: a few roots, every other key added into a random class
+ * usage: reserve_benchmark [keys] [case]
+ * case 0 runs all of them in one process, 1, 2, 3 run a single one on a fresh heap
+ */
+struct flat_pool_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::pool_storage;
+};
+struct flat_index_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, _Policy>;
+
+template <typename _Set> void load(_Set& _s, const std::vector<uint32_t>& _targets, uint32_t _classes) {
+    const uint32_t _n = _targets.size();
+    for (uint32_t _i = 0; _i != _classes; ++_i) _s.add(_i);
+    for (uint32_t _i = _classes; _i != _n; ++_i) _s.add(_i, _targets[_i]);
+}
+
+template <typename _Set> void run(const char* _kind, const std::vector<uint32_t>& _targets, uint32_t _classes) {
+    char _name[64];
+    const uint32_t _n = _targets.size();
+    {
+        _Set _s;
+        snprintf(_name, sizeof(_name), "%s load", _kind);
+        icy_bench(_name, _n, [&]() { load(_s, _targets, _classes); });
+        icy_keep(_s);
+    }
+    {
+        _Set _s;
+        snprintf(_name, sizeof(_name), "%s reserve(n, classes) + load", _kind);
+        icy_bench(_name, _n, [&]() {
+            _s.reserve(_n, _classes);
+            load(_s, _targets, _classes);
+        });
+        snprintf(_name, sizeof(_name), "%s del_all(k) but one class", _kind);
+        icy_bench(_name, _n, [&]() {
+            for (uint32_t _i = 1; _i != _classes; ++_i) _s.del_all(_i);
+        });
+        snprintf(_name, sizeof(_name), "%s shrink_to_fit()", _kind);
+        icy_bench(_name, _n, [&]() { _s.shrink_to_fit(); });
+        icy_keep(_s);
+    }
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 4000000);
+    const uint32_t _classes = 100;
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _class(0, _classes - 1);
+    std::vector<uint32_t> _targets(_n);
+    for (auto& _t : _targets) _t = _class(_gen);
+    const size_t _case = icy_arg(_argc, _argv, 2, 0);
+    if (_case == 0 || _case == 1) run<icy::disjoint_set<uint32_t>>("hash/pointer", _targets, _classes);
+    if (_case == 0 || _case == 2) run<set_type<flat_pool_policy>>("flat/pool", _targets, _classes);
+    if (_case == 0 || _case == 3) run<set_type<flat_index_policy>>("flat/index", _targets, _classes);
+    return 0;
+}
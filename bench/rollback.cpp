@@ -0,0 +1,77 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * speculative merges on a large partition: each trial merges a few edges, reads the result and is abandoned,
+ * restored by `rollback` to a checkpoint, or by copying the container beforehand
+ * usage: rollback_benchmark [keys] [trials] [merges per trial]
+ */
+struct none_policy : public icy::disjoint_policy {
+    using compress_policy = icy::compress_none;
+};
+struct dense_none_policy : public icy::dense_policy {
+    using compress_policy = icy::compress_none;
+    using storage_policy = icy::pool_storage;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, _Policy>;
+
+template <typename _Set> void run(const char* _kind, uint32_t _n, size_t _trials, const std::vector<std::pair<uint32_t, uint32_t>>& _edges) {
+    char _name[64];
+    const size_t _k = _edges.size() / _trials;
+    _Set _s;
+    for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+    for (uint32_t _i = 1; _i < _n; _i += 2) _s.merge(_i - 1, _i);
+    size_t _kept = 0;
+    {
+        _Set _t = _s, _u = _s;
+        snprintf(_name, sizeof(_name), "%s merge, not logged", _kind);
+        icy_bench(_name, _edges.size(), [&]() {
+            for (const auto& [_x, _y] : _edges) _t.merge(_x, _y);
+        });
+        _u.checkpoint();
+        snprintf(_name, sizeof(_name), "%s merge, logged", _kind);
+        icy_bench(_name, _edges.size(), [&]() {
+            for (const auto& [_x, _y] : _edges) _u.merge(_x, _y);
+        });
+        _kept += _t.classification() + _u.classification();
+    }
+    snprintf(_name, sizeof(_name), "%s trial by checkpoint + rollback", _kind);
+    icy_bench(_name, _trials, [&]() {
+        for (size_t _i = 0; _i != _trials; ++_i) {
+            const auto _c = _s.checkpoint();
+            for (size_t _j = _i * _k; _j != (_i + 1) * _k; ++_j) _s.merge(_edges[_j].first, _edges[_j].second);
+            _kept += _s.classification();
+            _s.rollback(_c);
+        }
+        _s.commit();
+    });
+    const size_t _copies = _trials < 10 ? _trials : 10;
+    snprintf(_name, sizeof(_name), "%s trial by copy (%zu trials)", _kind, _copies);
+    icy_bench(_name, _copies, [&]() {
+        for (size_t _i = 0; _i != _copies; ++_i) {
+            _Set _t = _s;
+            for (size_t _j = _i * _k; _j != (_i + 1) * _k; ++_j) _t.merge(_edges[_j].first, _edges[_j].second);
+            _kept += _t.classification();
+        }
+    });
+    icy_keep(_kept);
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 1000000);
+    const size_t _trials = icy_arg(_argc, _argv, 2, 10000);
+    const size_t _k = icy_arg(_argc, _argv, 3, 16);
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> _edges(_trials * _k);
+    for (auto& _e : _edges) _e = {_key(_gen), _key(_gen)};
+    run<set_type<none_policy>>("hash/pointer", _n, _trials, _edges);
+    run<set_type<dense_none_policy>>("dense/pool", _n, _trials, _edges);
+    return 0;
+}
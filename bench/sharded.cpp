@@ -0,0 +1,61 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * ingest throughput, writers add their share of the keys then merge their share of the edges,
+ * one `disjoint_set` under one mutex against a `sharded_disjoint_set`
+ * usage: sharded_benchmark [keys] [edges] [max writers] [shards]
+ * the writers double from 1 up to max writers, 0 shards for the hardware threads
+ */
+struct locked_set {
+    auto add(uint32_t _k) -> bool { std::lock_guard _locked(_lock); return _set.add(_k); }
+    auto merge(uint32_t _x, uint32_t _y) -> bool { std::lock_guard _locked(_lock); return _set.merge(_x, _y); }
+    auto classification() const -> size_t { return _set.classification(); }
+    std::mutex _lock;
+    icy::disjoint_set<uint32_t> _set;
+};
+
+template <typename _Make> void run(const char* _kind, uint32_t _n, const std::vector<std::pair<uint32_t, uint32_t>>& _edges, unsigned _writers, _Make&& _make) {
+    char _name[64];
+    for (unsigned _t = 1; _t <= _writers; _t *= 2) {
+        auto _s = _make();
+        snprintf(_name, sizeof(_name), "%s %u writers", _kind, _t);
+        icy_bench(_name, _n + _edges.size(), [&]() {
+            std::vector<std::jthread> _workers;
+            for (unsigned _i = 0; _i != _t; ++_i) {
+                _workers.emplace_back([&, _i]() {
+                    for (uint32_t _k = _i; _k < _n; _k += _t) _s->add(_k);
+                });
+            }
+            _workers.clear();
+            for (unsigned _i = 0; _i != _t; ++_i) {
+                _workers.emplace_back([&, _i]() {
+                    for (size_t _j = _i; _j < _edges.size(); _j += _t) _s->merge(_edges[_j].first, _edges[_j].second);
+                });
+            }
+        });
+        icy_keep(_s->classification());
+    }
+}
+
+int main(int _argc, char** _argv) {
+    const uint32_t _n = icy_arg(_argc, _argv, 1, 1000000);
+    const uint32_t _m = icy_arg(_argc, _argv, 2, 1000000);
+    const unsigned _writers = icy_arg(_argc, _argv, 3, 64);
+    const size_t _shards = icy_arg(_argc, _argv, 4, 0);
+    std::mt19937 _gen(_m);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> _edges(_m);
+    for (auto& _e : _edges) _e = {_key(_gen), _key(_gen)};
+    run("locked", _n, _edges, _writers, []() { return std::make_unique<locked_set>(); });
+    run("sharded", _n, _edges, _writers, [_shards]() { return std::make_unique<icy::sharded_disjoint_set<uint32_t>>(_shards); });
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * short string keys in the style of test/world_war2.cpp: std::unordered_map against the flat table
+ * usage: string_keys_benchmark [keys] [case]
+ * case 0 runs all of them in one process, 1, 2, 3 run a single one on a fresh heap
+ */
+struct flat_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+};
+struct flat_index_policy : public flat_policy {
+    using storage_policy = icy::index_storage;
+};
+using hash_set = icy::disjoint_set<std::string>;
+using flat_set = icy::disjoint_set<std::string, std::hash<std::string>, std::allocator<std::string>, flat_policy>;
+using flat_index_set = icy::disjoint_set<std::string, std::hash<std::string>, std::allocator<std::string>, flat_index_policy>;
+
+/**
+ * @brief country-like tags, three letters and a serial number
+ */
+auto make_keys(size_t _n) -> std::vector<std::string> {
+    static const char* _tags[] = {"chi", "jap", "ger", "eng", "sov", "usa", "fra", "ita", "pol", "rom"};
+    std::vector<std::string> _keys; _keys.reserve(_n);
+    for (size_t _i = 0; _i != _n; ++_i) _keys.push_back(_tags[_i % 10] + std::to_string(_i));
+    return _keys;
+}
+
+template <typename _Set> void run(const char* _kind, const std::vector<std::string>& _keys, const std::vector<uint32_t>& _order) {
+    char _name[64];
+    const size_t _n = _keys.size();
+    _Set _s;
+    snprintf(_name, sizeof(_name), "%s add(k, target)", _kind);
+    icy_bench(_name, _n, [&]() {
+        for (size_t _i = 0; _i != 1000 && _i != _n; ++_i) _s.add(_keys[_i]);
+        for (size_t _i = 1000; _i < _n; ++_i) _s.add(_keys[_i], _keys[_i % 1000]);
+    });
+    snprintf(_name, sizeof(_name), "%s contains(k), hit", _kind);
+    icy_bench(_name, _n, [&]() {
+        size_t _sum = 0;
+        for (uint32_t _i : _order) _sum += _s.contains(_keys[_i]);
+        icy_keep(_sum);
+    });
+    const std::string _absent = "xxx";
+    snprintf(_name, sizeof(_name), "%s contains(k), miss", _kind);
+    icy_bench(_name, _n, [&]() {
+        size_t _sum = 0;
+        for (uint32_t _i : _order) _sum += _s.contains(_keys[_i] + _absent);
+        icy_keep(_sum);
+    });
+    snprintf(_name, sizeof(_name), "%s sibling(k)", _kind);
+    icy_bench(_name, _n, [&]() {
+        size_t _sum = 0;
+        for (uint32_t _i : _order) _sum += _s.sibling(_keys[_i]);
+        icy_keep(_sum);
+    });
+    snprintf(_name, sizeof(_name), "%s sibling(x, y)", _kind);
+    icy_bench(_name, _n, [&]() {
+        size_t _sum = 0;
+        for (size_t _i = 0; _i != _n; ++_i) _sum += _s.sibling(_keys[_order[_i]], _keys[_i]);
+        icy_keep(_sum);
+    });
+}
+
+int main(int _argc, char** _argv) {
+    const size_t _n = icy_arg(_argc, _argv, 1, 2000000);
+    const auto _keys = make_keys(_n);
+    std::vector<uint32_t> _order(_n);
+    for (size_t _i = 0; _i != _n; ++_i) _order[_i] = _i;
+    std::shuffle(_order.begin(), _order.end(), std::mt19937(_n));
+    const size_t _case = icy_arg(_argc, _argv, 2, 0);
+    if (_case == 0 || _case == 1) run<hash_set>("hash", _keys, _order);
+    if (_case == 0 || _case == 2) run<flat_set>("flat", _keys, _order);
+    if (_case == 0 || _case == 3) run<flat_index_set>("flat+index", _keys, _order);
+    return 0;
+}
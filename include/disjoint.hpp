@@ -3,16 +3,589 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <type_traits>
+#include <concepts>
 #include <vector>
 #include <memory>
 #include <unordered_map>
-#include <unordered_set>
 #include <stdexcept>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <bit>
+#include <iterator>
+#include <ranges>
+#include <atomic>
+#include <thread>
+#include <tuple>
+#include <array>
+#include <mutex>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
 
 namespace icy {
 
+/**
+ * @brief merge policy, the classification of the first key always absorbs the other one
+ * @details the argument order decides the shape of the tree, which may degenerate into a chain
+ */
+struct merge_by_order {
+    static auto absorb(size_t, size_t) -> bool { return true; }
+};
+/**
+ * @brief merge policy, the smaller classification is appended to the larger one (union by size)
+ * @details the height of the tree is bounded by o(log(size))
+ */
+struct merge_by_size {
+    static auto absorb(size_t _x, size_t _y) -> bool { return _x >= _y; }
+};
+/**
+ * @brief compression policy, only the queried node is moved to the root header
+ */
+struct compress_node {
+    static constexpr bool node = true;
+    static constexpr bool path = false;
+};
+/**
+ * @brief compression policy, the queried node is moved to the root header,
+ * and every other header on the path is linked to its grandparent (path halving)
+ */
+struct compress_path {
+    static constexpr bool node = true;
+    static constexpr bool path = true;
+};
+/**
+ * @brief compression policy, lookups never modify the trees, so the const queries are truly read-only
+ * and may run concurrently under a shared lock, the trees are compressed explicitly by `compress()`
+ */
+struct compress_none {
+    static constexpr bool node = false;
+    static constexpr bool path = false;
+};
+/**
+ * @brief key policy, nodes do not know their keys,
+ * `del_all` and `del_except` scan the whole node dictionary for the members of the classification
+ */
+struct unkeyed_nodes {
+    static constexpr bool keyed = false;
+};
+/**
+ * @brief key policy, each node keeps a handle of its key in the node dictionary,
+ * `del_all` and `del_except` walk the tree of the classification, in o(size of the classification)
+ * @details the handle is a pointer to the stable key of `hash_dictionary`, or a copy of the key otherwise
+ */
+struct keyed_nodes {
+    static constexpr bool keyed = true;
+};
+/**
+ * @brief feed policy, no change is reported, the containers carry nothing for it
+ */
+struct no_feed {
+    static constexpr size_t capacity = 0;
+};
+/**
+ * @brief feed policy, each change of the classifications is pushed into a lock-free ring of @c _Capacity events,
+ * taken by one consumer thread through `poll`
+ * @details the writer never waits: the last free slot is kept for a `reset`, pushed in place of the change that would
+ * take it, and the changes that follow are dropped until the consumer has taken that `reset`
+ */
+template <size_t _Capacity = 4096> struct ring_feed {
+    static_assert(std::has_single_bit(_Capacity), "the capacity of the ring must be a power of 2");
+    static constexpr size_t capacity = _Capacity;
+};
+/**
+ * @brief 32-bit handle of an object in a slab
+ */
+template <typename _Tp> struct index_pointer {
+    using index_type = uint32_t;
+    static constexpr index_type npos = ~index_type(0);
+    constexpr index_pointer() = default;
+    constexpr explicit index_pointer(index_type _i) : _i(_i) {}
+    constexpr explicit operator bool() const { return _i != npos; }
+    constexpr auto index() const -> index_type { return _i; }
+    friend constexpr auto operator==(index_pointer _x, index_pointer _y) -> bool { return _x._i == _y._i; }
+private:
+    index_type _i = npos;
+};
+/**
+ * @brief storage policy, nodes and headers are allocated one by one and linked by raw pointers
+ */
+struct pointer_storage {
+    template <typename _Tp> using pointer = _Tp*;
+    using size_type = size_t;
+};
+/**
+ * @brief storage policy, nodes and headers live in slabs and are linked by 32-bit indices
+ * @details roughly halves the footprint of the links, at most 2^32 - 1 nodes and headers
+ */
+struct index_storage {
+    template <typename _Tp> using pointer = index_pointer<_Tp>;
+    using size_type = uint32_t;
+};
+/**
+ * @brief storage policy, nodes and headers are carved from pooled chunks and linked by raw pointers
+ * @details released objects are reused through free lists, and `clear` returns the chunks at once
+ */
+struct pool_storage {
+    template <typename _Tp> using pointer = _Tp*;
+    using size_type = size_t;
+};
+
+namespace {
+/**
+ * @brief hint the cache to load the line holding @c _p, nothing on compilers without the builtin
+ */
+inline auto prefetch(const void* _p) -> void {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(_p);
+#else
+    (void)_p;
+#endif
+}
+/**
+ * @brief node dictionary backed by std::unordered_map
+ */
+template <typename _Key, typename _Mapped, typename _Hash> struct hash_table {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using table_type = std::unordered_map<key_type, mapped_type, _Hash>;
+    using const_iterator = typename table_type::const_iterator;
+    /// the keys of std::unordered_map never move, a node refers to its key by address
+    using key_handle = const key_type*;
+public:
+    /**
+     * @brief return the mapped handle, or a null handle when the key is absent
+     */
+    auto find(const key_type& _k) const -> mapped_type {
+        const auto _i = _table.find(_k);
+        return _i == _table.cend() ? mapped_type{} : _i->second;
+    }
+    auto at(const key_type& _k) const -> mapped_type { return _table.at(_k); }
+    auto contains(const key_type& _k) const -> bool { return _table.contains(_k); }
+    /**
+     * @pre the key is absent
+     * @return the handle of the inserted key
+     */
+    auto insert(const key_type& _k, mapped_type _m) -> key_handle { return &_table.emplace(_k, _m).first->first; }
+    /**
+     * @details @c _k may be the key of the erased entry itself
+     */
+    auto erase(const key_type& _k) -> void {
+        const auto _i = _table.find(_k);
+        if (_i != _table.cend()) _table.erase(_i);
+    }
+    auto key(const key_handle& _h) const -> const key_type& { return *_h; }
+    /**
+     * @brief nothing, the buckets of std::unordered_map are not reachable without walking them
+     */
+    auto prefetch(const key_type&) const -> void {}
+    /**
+     * @brief erase each entry satisfying the predicate
+     * @tparam _Pred [](const key_type&, mapped_type) -> bool {}
+     */
+    template <typename _Pred> auto erase_if(const _Pred& _pred) -> void {
+        for (auto _i = _table.cbegin(); _i != _table.cend();) {
+            if (_pred(_i->first, _i->second)) _i = _table.erase(_i);
+            else ++_i;
+        }
+    }
+    auto size() const -> size_t { return _table.size(); }
+    auto empty() const -> bool { return _table.empty(); }
+    auto clear() -> void { _table.clear(); }
+    auto reserve(size_t _n) -> void { _table.reserve(_n); }
+    auto shrink_to_fit() -> void { _table.rehash(0); }
+    auto begin() const -> const_iterator { return _table.cbegin(); }
+    auto end() const -> const_iterator { return _table.cend(); }
+    auto swap(hash_table& _rhs) noexcept -> void { _table.swap(_rhs._table); }
+private:
+    table_type _table;
+};
+/**
+ * @brief node dictionary backed by a flat array, the key is the offset of its slot
+ * @details only suitable for dense non-negative integral keys, the array grows up to the largest key
+ */
+template <typename _Key, typename _Mapped> struct dense_table {
+    static_assert(std::is_integral_v<_Key>, "dense_table requires integral keys");
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<key_type, mapped_type>;
+    struct const_iterator {
+        auto operator*() const -> value_type { return {static_cast<key_type>(_i), (*_slots)[_i]}; }
+        auto operator++() -> const_iterator& {
+            for (++_i; _i != _slots->size() && !(*_slots)[_i]; ++_i);
+            return *this;
+        }
+        auto operator==(const const_iterator& _rhs) const -> bool { return _i == _rhs._i; }
+        const std::vector<mapped_type>* _slots;
+        size_t _i;
+    };
+    /// the key is its own handle
+    using key_handle = key_type;
+public:
+    auto find(const key_type& _k) const -> mapped_type {
+        if (!std::in_range<size_t>(_k) || static_cast<size_t>(_k) >= _slots.size()) return mapped_type{};
+        return _slots[static_cast<size_t>(_k)];
+    }
+    auto at(const key_type& _k) const -> mapped_type {
+        const mapped_type _m = find(_k);
+        if (!_m) throw std::out_of_range("dense_table::at");
+        return _m;
+    }
+    auto contains(const key_type& _k) const -> bool { return static_cast<bool>(find(_k)); }
+    auto insert(const key_type& _k, mapped_type _m) -> key_handle {
+        if (!std::in_range<size_t>(_k)) throw std::out_of_range("dense_table::insert");
+        const size_t _i = static_cast<size_t>(_k);
+        if (_i >= _slots.size()) _slots.resize(std::max(_i + 1, _slots.size() * 2));
+        assert(!_slots[_i]);
+        _slots[_i] = _m;
+        ++_size;
+        return _k;
+    }
+    auto erase(const key_type& _k) -> void {
+        if (!contains(_k)) return;
+        _slots[static_cast<size_t>(_k)] = mapped_type{};
+        --_size;
+    }
+    auto key(const key_handle& _h) const -> const key_type& { return _h; }
+    /**
+     * @brief load the slot of the key into the cache ahead of `find`
+     */
+    auto prefetch(const key_type& _k) const -> void {
+        if (std::in_range<size_t>(_k) && static_cast<size_t>(_k) < _slots.size()) icy::prefetch(_slots.data() + static_cast<size_t>(_k));
+    }
+    template <typename _Pred> auto erase_if(const _Pred& _pred) -> void {
+        for (size_t _i = 0; _i != _slots.size(); ++_i) {
+            if (_slots[_i] && _pred(static_cast<key_type>(_i), _slots[_i])) {
+                _slots[_i] = mapped_type{};
+                --_size;
+            }
+        }
+    }
+    auto size() const -> size_t { return _size; }
+    auto empty() const -> bool { return _size == 0; }
+    auto clear() -> void { _slots.clear(); _size = 0; }
+    /**
+     * @brief make room for the keys [0, _n)
+     */
+    auto reserve(size_t _n) -> void {
+        if (_n > _slots.size()) _slots.resize(_n);
+    }
+    /**
+     * @brief drop the slots after the largest key
+     */
+    auto shrink_to_fit() -> void {
+        while (!_slots.empty() && !_slots.back()) _slots.pop_back();
+        _slots.shrink_to_fit();
+    }
+    auto begin() const -> const_iterator {
+        const_iterator _i {&_slots, 0};
+        if (!_slots.empty() && !_slots[0]) ++_i;
+        return _i;
+    }
+    auto end() const -> const_iterator { return {&_slots, _slots.size()}; }
+    auto swap(dense_table& _rhs) noexcept -> void {
+        _slots.swap(_rhs._slots);
+        std::swap(_size, _rhs._size);
+    }
+private:
+    std::vector<mapped_type> _slots;
+    size_t _size = 0;
+};
+/**
+ * @brief node dictionary backed by an open addressing table with Robin Hood probing
+ * @details entries live inline in one array, each slot records its distance to the home slot (0 for an empty one),
+ * a lookup stops at the first slot closer to its home than the probe, and erasure shifts the following entries back,
+ * so there are no tombstones and no per-entry allocation,
+ * a poor hash only lengthens the probes as it lengthens the buckets of std::unordered_map
+ */
+template <typename _Key, typename _Mapped, typename _Hash> struct flat_table {
+    using key_type = _Key;
+    using mapped_type = _Mapped;
+    using value_type = std::pair<key_type, mapped_type>;
+    using distance_type = uint32_t;
+    using allocator_type = std::allocator<value_type>;
+    struct const_iterator {
+        auto operator*() const -> const value_type& { return _t->_slots[_i]; }
+        auto operator->() const -> const value_type* { return _t->_slots + _i; }
+        auto operator++() -> const_iterator& {
+            for (++_i; _i != _t->_capacity && _t->_distance[_i] == 0; ++_i);
+            return *this;
+        }
+        auto operator==(const const_iterator& _rhs) const -> bool { return _i == _rhs._i; }
+        const flat_table* _t;
+        size_t _i;
+    };
+    static constexpr size_t npos = -1;
+    /// the entries move on insertion and erasure, a node keeps a copy of its key
+    using key_handle = key_type;
+public:
+    flat_table() = default;
+    flat_table(const flat_table& _rhs) : _hash(_rhs._hash) {
+        if (_rhs._size == 0) return;
+        _M_rehash(_rhs._capacity);
+        for (const auto& _v : _rhs) _M_insert(value_type(_v));
+    }
+    auto operator=(const flat_table& _rhs) -> flat_table& {
+        if (&_rhs == this) return *this;
+        flat_table _t(_rhs);
+        swap(_t);
+        return *this;
+    }
+    ~flat_table() { clear(); }
+public:
+    auto find(const key_type& _k) const -> mapped_type {
+        const size_t _i = _M_find(_k);
+        return _i == npos ? mapped_type{} : _slots[_i].second;
+    }
+    auto at(const key_type& _k) const -> mapped_type {
+        const size_t _i = _M_find(_k);
+        if (_i == npos) throw std::out_of_range("flat_table::at");
+        return _slots[_i].second;
+    }
+    auto contains(const key_type& _k) const -> bool { return _M_find(_k) != npos; }
+    /**
+     * @pre the key is absent
+     */
+    auto insert(const key_type& _k, mapped_type _m) -> key_handle {
+        assert(!contains(_k));
+        value_type _v(_k, _m);
+        if ((_size + 1) * 8 > _capacity * 7) _M_rehash(_S_capacity_for(_capacity + 1));
+        _M_insert(std::move(_v));
+        return _k;
+    }
+    auto erase(const key_type& _k) -> void {
+        const size_t _i = _M_find(_k);
+        if (_i != npos) _M_erase(_i);
+    }
+    auto key(const key_handle& _h) const -> const key_type& { return _h; }
+    /**
+     * @brief load the home slot of the key into the cache ahead of `find`
+     */
+    auto prefetch(const key_type& _k) const -> void {
+        if (_size == 0) return;
+        const size_t _i = _M_home(_k);
+        icy::prefetch(_distance.get() + _i);
+        icy::prefetch(_slots + _i);
+    }
+    /**
+     * @details an erasure shifts the following entries back into the current slot, so the slot is visited again,
+     * an entry wrapping around to the end of the array may be tested twice, which is harmless for a survivor
+     */
+    template <typename _Pred> auto erase_if(const _Pred& _pred) -> void {
+        for (size_t _i = 0; _i != _capacity;) {
+            if (_distance[_i] != 0 && _pred(_slots[_i].first, _slots[_i].second)) _M_erase(_i);
+            else ++_i;
+        }
+    }
+    auto size() const -> size_t { return _size; }
+    auto empty() const -> bool { return _size == 0; }
+    auto clear() -> void {
+        for (size_t _i = 0; _i != _capacity; ++_i) {
+            if (_distance[_i] != 0) std::destroy_at(_slots + _i);
+        }
+        if (_slots != nullptr) allocator_type().deallocate(_slots, _capacity);
+        _slots = nullptr; _distance.reset();
+        _capacity = 0; _size = 0; _shift = 64;
+    }
+    auto reserve(size_t _n) -> void {
+        const size_t _c = _S_capacity_for(_n);
+        if (_c > _capacity) _M_rehash(_c);
+    }
+    auto shrink_to_fit() -> void {
+        if (_size == 0) { clear(); return; }
+        const size_t _c = _S_capacity_for(_size);
+        if (_c < _capacity) _M_rehash(_c);
+    }
+    auto begin() const -> const_iterator {
+        const_iterator _i {this, 0};
+        if (_capacity != 0 && _distance[0] == 0) ++_i;
+        return _i;
+    }
+    auto end() const -> const_iterator { return {this, _capacity}; }
+    auto swap(flat_table& _rhs) noexcept -> void {
+        std::swap(_hash, _rhs._hash);
+        std::swap(_slots, _rhs._slots);
+        std::swap(_distance, _rhs._distance);
+        std::swap(_capacity, _rhs._capacity);
+        std::swap(_size, _rhs._size);
+        std::swap(_shift, _rhs._shift);
+    }
+private:
+    /**
+     * @brief the smallest capacity holding @c _n entries under the maximum load factor 7/8
+     */
+    static auto _S_capacity_for(size_t _n) -> size_t {
+        size_t _c = 16;
+        while (_c * 7 < _n * 8) _c *= 2;
+        return _c;
+    }
+    /**
+     * @brief home slot of the key, fibonacci hashing spreads identity hashes over the high bits
+     */
+    auto _M_home(const key_type& _k) const -> size_t {
+        return static_cast<size_t>((static_cast<uint64_t>(_hash(_k)) * 0x9e3779b97f4a7c15ull) >> _shift);
+    }
+    auto _M_find(const key_type& _k) const -> size_t {
+        if (_size == 0) return npos;
+        size_t _i = _M_home(_k);
+        for (distance_type _d = 1; _distance[_i] >= _d; ++_d, _i = (_i + 1) & (_capacity - 1)) {
+            // an entry sharing the home slot of the key has exactly the probe distance
+            if (_distance[_i] == _d && std::equal_to<key_type>()(_slots[_i].first, _k)) return _i;
+        }
+        return npos;
+    }
+    /**
+     * @brief place the entry, displacing the entries closer to their home
+     * @details grows the table when a probe distance no longer fits in `distance_type`
+     */
+    auto _M_insert(value_type&& _v) -> void {
+        size_t _i = _M_home(_v.first);
+        for (distance_type _d = 1; ; ++_d, _i = (_i + 1) & (_capacity - 1)) {
+            if (_distance[_i] == 0) {
+                std::construct_at(_slots + _i, std::move(_v));
+                _distance[_i] = _d;
+                ++_size;
+                return;
+            }
+            if (_distance[_i] < _d) {
+                std::swap(_slots[_i], _v);
+                std::swap(_distance[_i], _d);
+            }
+            if (_d == std::numeric_limits<distance_type>::max()) {
+                _M_rehash(_capacity * 2);
+                _M_insert(std::move(_v));
+                return;
+            }
+        }
+    }
+    auto _M_erase(size_t _i) -> void {
+        for (size_t _j = (_i + 1) & (_capacity - 1); _distance[_j] > 1; _i = _j, _j = (_j + 1) & (_capacity - 1)) {
+            _slots[_i] = std::move(_slots[_j]);
+            _distance[_i] = _distance[_j] - 1;
+        }
+        std::destroy_at(_slots + _i);
+        _distance[_i] = 0;
+        --_size;
+    }
+    /**
+     * @param _capacity a power of two
+     */
+    auto _M_rehash(size_t _capacity) -> void {
+        flat_table _t;
+        _t._hash = _hash;
+        _t._slots = allocator_type().allocate(_capacity);
+        _t._distance = std::make_unique<distance_type[]>(_capacity);
+        _t._capacity = _capacity;
+        _t._shift = 64 - std::countr_zero(_capacity);
+        for (size_t _i = 0; _i != this->_capacity; ++_i) {
+            if (_distance[_i] != 0) _t._M_insert(std::move(_slots[_i]));
+        }
+        swap(_t);
+    }
+private:
+    [[no_unique_address]] _Hash _hash;
+    value_type* _slots = nullptr;
+    std::unique_ptr<distance_type[]> _distance;
+    size_t _capacity = 0;
+    size_t _size = 0;
+    unsigned _shift = 64;
+};
+}
+/**
+ * @brief dictionary policy, keys are hashed into std::unordered_map
+ */
+struct hash_dictionary {
+    template <typename _Key, typename _Mapped, typename _Hash> using type = hash_table<_Key, _Mapped, _Hash>;
+    template <typename _Key> using key_handle = const _Key*;
+};
+/**
+ * @brief dictionary policy, dense non-negative integral keys index a flat array, no hashing at all
+ */
+struct dense_dictionary {
+    template <typename _Key, typename _Mapped, typename _Hash> using type = dense_table<_Key, _Mapped>;
+    template <typename _Key> using key_handle = _Key;
+};
+/**
+ * @brief dictionary policy, keys are hashed into a flat open addressing table
+ * @details no allocation per key and lookups touch contiguous slots, suits any hashable key such as strings
+ */
+struct flat_dictionary {
+    template <typename _Key, typename _Mapped, typename _Hash> using type = flat_table<_Key, _Mapped, _Hash>;
+    template <typename _Key> using key_handle = _Key;
+};
+/**
+ * @brief default policy of disjoint containers
+ * @details derive from it and override the member types to customize the containers
+ */
+struct disjoint_policy {
+    /// decide which root header absorbs the other one in `merge`
+    using merge_policy = merge_by_size;
+    /// decide how the path to the root header is shortened when a key is looked up
+    using compress_policy = compress_path;
+    /// decide how nodes and headers are allocated and linked
+    using storage_policy = pointer_storage;
+    /// decide how keys are mapped to nodes
+    using dictionary_policy = hash_dictionary;
+    /// decide whether a node refers back to its key
+    using key_policy = unkeyed_nodes;
+    /// decide whether the changes of the classifications are reported
+    using feed_policy = no_feed;
+};
+/**
+ * @brief policy for dense integral keys, the node dictionary is a flat array
+ */
+struct dense_policy : public disjoint_policy {
+    using dictionary_policy = dense_dictionary;
+};
+/**
+ * @brief how `save` writes a key or a value and `load` reads it back
+ * @details trivially copyable types are copied byte by byte in native byte order, strings are prefixed by their length,
+ * specialize it for other types
+ */
+template <typename _Tp> struct serializer;
+template <typename _Tp> requires std::is_trivially_copyable_v<_Tp> struct serializer<_Tp> {
+    static auto write(std::ostream& _out, const _Tp& _v) -> void { _out.write(reinterpret_cast<const char*>(std::addressof(_v)), sizeof(_Tp)); }
+    static auto read(std::istream& _in) -> _Tp {
+        _Tp _v;
+        _in.read(reinterpret_cast<char*>(std::addressof(_v)), sizeof(_Tp));
+        return _v;
+    }
+};
+template <typename _Char, typename _Traits, typename _Alloc> struct serializer<std::basic_string<_Char, _Traits, _Alloc>> {
+    using value_type = std::basic_string<_Char, _Traits, _Alloc>;
+    static auto write(std::ostream& _out, const value_type& _v) -> void {
+        const uint64_t _n = _v.size();
+        _out.write(reinterpret_cast<const char*>(&_n), sizeof(_n));
+        _out.write(reinterpret_cast<const char*>(_v.data()), _n * sizeof(_Char));
+    }
+    static auto read(std::istream& _in) -> value_type {
+        uint64_t _n = 0;
+        _in.read(reinterpret_cast<char*>(&_n), sizeof(_n));
+        value_type _v;
+        // read in chunks, a corrupted length stops at the end of the file rather than allocating it at once
+        for (uint64_t _left = _n; _left != 0 && _in;) {
+            const uint64_t _chunk = std::min<uint64_t>(_left, 4096);
+            const size_t _at = _v.size();
+            _v.resize(_at + _chunk);
+            _in.read(reinterpret_cast<char*>(_v.data() + _at), _chunk * sizeof(_Char));
+            _left -= _chunk;
+        }
+        return _v;
+    }
+};
+
 namespace {
+/**
+ * @brief payload of a node
+ * @details not polymorphic, nodes are always destroyed through the concrete type,
+ * and `storage<void>` is an empty base, so a set-only node only holds its links
+ */
 template <typename _Tp> struct storage;
 template <typename _Tp> struct storage {
 public:
@@ -20,11 +593,12 @@ public:
 public:
     template <typename... _Args> storage(_Args&&... _args) : _v(std::forward<_Args>(_args)...) {}
     storage(const storage&) = default;
-    virtual ~storage() = default;
+    ~storage() = default;
 public:
     inline auto value() -> value_type& { return _v; }
     inline auto value() const -> const value_type& { return _v; }
     inline auto set_value(const value_type& _v) -> void { this->_v = _v; }
+    inline auto set_value(value_type&& _v) -> void { this->_v = std::move(_v); }
 private:
     value_type _v;
 };
@@ -34,250 +608,1235 @@ public:
 public:
     storage() = default;
     storage(const storage&) = default;
-    virtual ~storage() = default;
+    ~storage() = default;
+};
+/**
+ * @brief tag of a payload that also keeps the handle of its key in the node dictionary
+ */
+template <typename _Tp, typename _Handle> struct keyed;
+template <typename _Tp, typename _Handle> struct storage<keyed<_Tp, _Handle>> : public storage<_Tp> {
+public:
+    using base = storage<_Tp>;
+    using value_type = _Tp;
+    using key_handle = _Handle;
+public:
+    template <typename... _Args> storage(_Args&&... _args) : base(std::forward<_Args>(_args)...) {}
+    storage(const storage&) = default;
+    ~storage() = default;
+public:
+    inline auto key() const -> const key_handle& { return _key; }
+    inline auto set_key(const key_handle& _k) -> void { _key = _k; }
+private:
+    key_handle _key {};
 };
 }
 
 namespace {
 
-template <typename _Tp, typename _Alloc> struct alloc;
+template <typename _Tp, typename _Alloc, typename _Storage> struct alloc;
+template <typename _Tp, typename _Alloc, typename _Storage> struct forest;
 
-template <typename _Tp> struct node;
-template <typename _Tp> struct header;
+template <typename _Tp, typename _Storage> struct node;
+template <typename _Tp, typename _Storage> struct header;
 
-template <typename _Tp> struct node : public storage<_Tp> {
-    using self = node<_Tp>;
+/**
+ * @brief leaf of the short tree, holds the payload
+ * @details the links are handles of the storage policy, they are resolved and modified by `forest`
+ */
+template <typename _Tp, typename _Storage> struct node : public storage<_Tp> {
+    using self = node<_Tp, _Storage>;
     using base = storage<_Tp>;
-    using value_type = _Tp;
-    using header_type = header<_Tp>;
+    using value_type = typename base::value_type;
+    using header_type = header<_Tp, _Storage>;
+    using node_pointer = typename _Storage::template pointer<self>;
+    using header_pointer = typename _Storage::template pointer<header_type>;
     template <typename... _Args> node(_Args&&... _args): base(std::forward<_Args>(_args)...) {}
     node(const self& _rhs) : base(_rhs) {}
     self& operator=(const self&) = delete;
-    virtual ~node() = default;
-    template <typename _T> friend struct header;
+    ~node() = default;
+    template <typename _T, typename _A, typename _S> friend struct forest;
 public:
-    const header_type* get() const { return _header; }
-    header_type* get() { return _header; }
-    header_type* unhook();
+    header_pointer get() const { return _header; }
 private:
-    self* _left = nullptr;
-    self* _right = nullptr;
-    header_type* _header = nullptr;
+    node_pointer _left {};
+    node_pointer _right {};
+    header_pointer _header {};
 };
-template <typename _Tp> struct header {
-    using self = header<_Tp>;
-    using node_type = node<_Tp>;
+/**
+ * @brief non-leaf of the short tree, only maintains the structure
+ */
+template <typename _Tp, typename _Storage> struct header {
+    using self = header<_Tp, _Storage>;
+    using node_type = node<_Tp, _Storage>;
+    using size_type = typename _Storage::size_type;
+    using node_pointer = typename _Storage::template pointer<node_type>;
+    using header_pointer = typename _Storage::template pointer<self>;
     header() = default;
     header(const self&) = default;
     self& operator=(const self&) = delete;
     ~header() = default;
-    template <typename _T> friend struct node;
+    template <typename _T, typename _A, typename _S> friend struct forest;
 public:
-    const self* get() const { return _header; }
-    self* get() { return _header; }
-    size_t size() const { return _node_count; }
-    void append_node(node_type* _n);
-    void append_header(self* _h);
-    self* unhook();
+    header_pointer get() const { return _header; }
+    /**
+     * @brief return the number of nodes in the tree
+     * @details only maintained for final headers, the counter of a sub-header is meaningless
+     */
+    size_type size() const { return _node_count; }
+    /**
+     * @brief return whether no node or header is attached
+     */
+    bool empty() const { return !_first_node && !_first; }
+private:
+    header_pointer _header {};
+    header_pointer _left {};
+    header_pointer _right {};
+    header_pointer _first {};
+    header_pointer _last {};
+    node_pointer _first_node {};
+    node_pointer _last_node {};
+    size_type _node_count = 0;
+};
+
+/**
+ * @brief allocate nodes and headers one by one, and link them by raw pointers
+ * @details also serves storage policies derived from `pointer_storage`, e.g. to override `size_type`
+ */
+template <typename _Tp, typename _Alloc, typename _Storage> requires std::derived_from<_Storage, pointer_storage>
+struct alloc<_Tp, _Alloc, _Storage> : public _Alloc {
+    /// whether all nodes and headers can be released at once by `_M_release`
+    static constexpr bool bulk_release = false;
+    typedef node<_Tp, _Storage> node_type;
+    typedef header<_Tp, _Storage> header_type;
+    typedef node_type* node_pointer;
+    typedef header_type* header_pointer;
+    typedef typename node_type::value_type value_type;
+    typedef _Alloc elt_allocator_type;
+    typedef std::allocator_traits<elt_allocator_type> elt_alloc_traits;
+    typedef typename elt_alloc_traits::template rebind_alloc<node_type> node_allocator_type;
+    typedef std::allocator_traits<node_allocator_type> node_alloc_traits;
+    typedef typename elt_alloc_traits::template rebind_alloc<header_type> header_allocator_type;
+    typedef std::allocator_traits<header_allocator_type> header_alloc_traits;
+
+    elt_allocator_type& _M_get_elt_allocator() { return *static_cast<elt_allocator_type*>(this); }
+    const elt_allocator_type& _M_get_elt_allocator() const { return *static_cast<const elt_allocator_type*>(this); }
+    node_allocator_type _M_get_node_allocator() const { return node_allocator_type(_M_get_elt_allocator()); }
+    header_allocator_type _M_get_header_allocator() const { return header_allocator_type(_M_get_elt_allocator()); }
+
+    node_type& _M_node(node_pointer _p) const { return *_p; }
+    header_type& _M_header(header_pointer _p) const { return *_p; }
+
+    template <typename... _Args> node_pointer _M_allocate_node(_Args&&... _args) const {
+        node_allocator_type _node_alloc = _M_get_node_allocator();
+        auto _ptr = node_alloc_traits::allocate(_node_alloc, 1);
+        node_type* _p = std::addressof(*_ptr);
+        node_alloc_traits::construct(_node_alloc, _p, std::forward<_Args>(_args)...);
+        return _p;
+    }
+    void _M_deallocate_node(node_pointer _p) const {
+        node_allocator_type _node_alloc = _M_get_node_allocator();
+        node_alloc_traits::destroy(_node_alloc, _p);
+        node_alloc_traits::deallocate(_node_alloc, _p, 1);
+    }
+    template <typename... _Args> header_pointer _M_allocate_header(_Args&&... _args) const {
+        header_allocator_type _header_alloc = _M_get_header_allocator();
+        auto _ptr = header_alloc_traits::allocate(_header_alloc, 1);
+        header_type* _p = std::addressof(*_ptr);
+        header_alloc_traits::construct(_header_alloc, _p, std::forward<_Args>(_args)...);
+        return _p;
+    }
+    void _M_deallocate_header(header_pointer _p) const {
+        header_allocator_type _header_alloc = _M_get_header_allocator();
+        header_alloc_traits::destroy(_header_alloc, _p);
+        header_alloc_traits::deallocate(_header_alloc, _p, 1);
+    }
+    /**
+     * @brief objects are allocated one by one, nothing to reserve or shrink
+     */
+    void _M_reserve(size_t, size_t) const {}
+    void _M_shrink_to_fit() const {}
+    /**
+     * @brief exchange the allocators, the objects belong to whoever holds the links
+     */
+    void _M_swap(alloc& _rhs) noexcept {
+        std::swap(_M_get_elt_allocator(), _rhs._M_get_elt_allocator());
+    }
+};
+
+/**
+ * @brief contiguous chunks of objects addressed by 32-bit indices
+ * @details chunks are never moved, so the objects keep their addresses;
+ * released slots are chained into a free list through their own bytes
+ */
+template <typename _Tp, typename _Alloc> struct slab : public _Alloc {
+    typedef _Tp value_type;
+    typedef _Alloc allocator_type;
+    typedef std::allocator_traits<allocator_type> alloc_traits;
+    typedef typename alloc_traits::template rebind_alloc<_Tp*> chunk_allocator_type;
+    typedef uint32_t index_type;
+    static constexpr index_type npos = ~index_type(0);
+    static constexpr index_type chunk_bits = 12u;
+    static constexpr index_type chunk_size = index_type(1) << chunk_bits;
+    static constexpr index_type chunk_mask = chunk_size - 1;
+    static_assert(sizeof(value_type) >= sizeof(index_type), "a released slot keeps the next free index");
+
+    slab(const allocator_type& _a = allocator_type()) : allocator_type(_a), _chunks(chunk_allocator_type(_a)) {}
+    slab(const slab&) = delete;
+    slab& operator=(const slab&) = delete;
+    ~slab() { release(); }
+
+    value_type& operator[](index_type _i) const { return _chunks[_i >> chunk_bits][_i & chunk_mask]; }
+    /**
+     * @brief return the number of live objects
+     */
+    index_type size() const { return _size; }
+    template <typename... _Args> index_type allocate(_Args&&... _args) {
+        index_type _i = _free;
+        if (_i != npos) {
+            std::memcpy(&_free, static_cast<void*>(std::addressof((*this)[_i])), sizeof(index_type));
+        }
+        else {
+            if (_end == npos) throw std::length_error("slab index overflow");
+            if ((_end >> chunk_bits) == _chunks.size()) {
+                // the table grows geometrically, and before the chunk so that a failed push_back cannot leak it
+                if (_chunks.size() == _chunks.capacity()) _chunks.reserve(std::max<size_t>(2 * _chunks.size(), 8));
+                _chunks.push_back(alloc_traits::allocate(*this, chunk_size));
+            }
+            _i = _end++;
+        }
+        try {
+            alloc_traits::construct(*this, std::addressof((*this)[_i]), std::forward<_Args>(_args)...);
+        }
+        catch (...) {
+            std::memcpy(static_cast<void*>(std::addressof((*this)[_i])), &_free, sizeof(index_type));
+            _free = _i;
+            throw;
+        }
+        ++_size;
+        return _i;
+    }
+    void deallocate(index_type _i) {
+        value_type* const _p = std::addressof((*this)[_i]);
+        alloc_traits::destroy(*this, _p);
+        std::memcpy(static_cast<void*>(_p), &_free, sizeof(index_type));
+        _free = _i;
+        --_size;
+    }
+    /**
+     * @brief allocate chunks up front until @c _n objects fit
+     */
+    void reserve(size_t _n) {
+        _n = std::min<size_t>(_n, npos);
+        const size_t _want = (_n + chunk_size - 1) / chunk_size;
+        _chunks.reserve(_want);
+        while (_chunks.size() < _want) _chunks.push_back(alloc_traits::allocate(*this, chunk_size));
+    }
+    /**
+     * @brief return the chunks no slot has been taken from, or all of them when no object is alive
+     * @details a chunk holding a live object cannot be returned, the objects never move
+     */
+    void shrink_to_fit() {
+        if (_size == 0) { release(); return; }
+        const size_t _used = (size_t(_end) + chunk_mask) >> chunk_bits;
+        for (size_t _i = _used; _i != _chunks.size(); ++_i) {
+            alloc_traits::deallocate(*this, _chunks[_i], chunk_size);
+        }
+        _chunks.resize(_used);
+        _chunks.shrink_to_fit();
+    }
+    /**
+     * @brief release all chunks, the live objects must have been destroyed or be trivially destructible
+     */
+    void release() {
+        for (value_type* _c : _chunks) {
+            alloc_traits::deallocate(*this, _c, chunk_size);
+        }
+        _chunks.clear();
+        _end = 0; _free = npos; _size = 0;
+    }
+    /**
+     * @brief exchange the chunks and the allocators, the objects stay where they are
+     */
+    void swap(slab& _rhs) noexcept {
+        std::swap(static_cast<allocator_type&>(*this), static_cast<allocator_type&>(_rhs));
+        _chunks.swap(_rhs._chunks);
+        std::swap(_end, _rhs._end);
+        std::swap(_free, _rhs._free);
+        std::swap(_size, _rhs._size);
+    }
+private:
+    std::vector<value_type*, chunk_allocator_type> _chunks;
+    index_type _end = 0;
+    index_type _free = npos;
+    index_type _size = 0;
+};
+
+/**
+ * @brief contiguous chunks of objects addressed by raw pointers
+ * @details chunks are never moved, objects are bumped from the last chunk,
+ * released slots are chained into a free list through their own bytes
+ */
+template <typename _Tp, typename _Alloc> struct pool : public _Alloc {
+    typedef _Tp value_type;
+    typedef _Alloc allocator_type;
+    typedef std::allocator_traits<allocator_type> alloc_traits;
+    typedef typename alloc_traits::template rebind_alloc<_Tp*> chunk_allocator_type;
+    static constexpr size_t chunk_size = 4096;
+    static_assert(sizeof(value_type) >= sizeof(value_type*), "a released slot keeps the next free slot");
+
+    pool(const allocator_type& _a = allocator_type()) : allocator_type(_a), _chunks(chunk_allocator_type(_a)) {}
+    pool(const pool&) = delete;
+    pool& operator=(const pool&) = delete;
+    ~pool() { release(); }
+
+    /**
+     * @brief return the number of live objects
+     */
+    size_t size() const { return _size; }
+    template <typename... _Args> value_type* allocate(_Args&&... _args) {
+        value_type* _p = _free;
+        if (_p != nullptr) {
+            std::memcpy(&_free, static_cast<void*>(_p), sizeof(value_type*));
+        }
+        else {
+            if (_end == _chunk_end) {
+                if (_used == _chunks.size()) {
+                    // the table grows geometrically, and before the chunk so that a failed push_back cannot leak it
+                    if (_chunks.size() == _chunks.capacity()) _chunks.reserve(std::max<size_t>(2 * _chunks.size(), 8));
+                    _chunks.push_back(alloc_traits::allocate(*this, chunk_size));
+                }
+                _end = _chunks[_used++]; _chunk_end = _end + chunk_size;
+            }
+            _p = _end++;
+        }
+        try {
+            alloc_traits::construct(*this, _p, std::forward<_Args>(_args)...);
+        }
+        catch (...) {
+            std::memcpy(static_cast<void*>(_p), &_free, sizeof(value_type*));
+            _free = _p;
+            throw;
+        }
+        ++_size;
+        return _p;
+    }
+    void deallocate(value_type* _p) {
+        alloc_traits::destroy(*this, _p);
+        std::memcpy(static_cast<void*>(_p), &_free, sizeof(value_type*));
+        _free = _p;
+        --_size;
+    }
+    /**
+     * @brief allocate chunks up front until @c _n objects fit
+     */
+    void reserve(size_t _n) {
+        const size_t _want = _n / chunk_size + (_n % chunk_size != 0);
+        _chunks.reserve(_want);
+        while (_chunks.size() < _want) _chunks.push_back(alloc_traits::allocate(*this, chunk_size));
+    }
+    /**
+     * @brief return the chunks no slot has been taken from, or all of them when no object is alive
+     * @details a chunk holding a live object cannot be returned, the objects never move
+     */
+    void shrink_to_fit() {
+        if (_size == 0) { release(); return; }
+        for (size_t _i = _used; _i != _chunks.size(); ++_i) {
+            alloc_traits::deallocate(*this, _chunks[_i], chunk_size);
+        }
+        _chunks.resize(_used);
+        _chunks.shrink_to_fit();
+    }
+    /**
+     * @brief release all chunks, the live objects must have been destroyed or be trivially destructible
+     */
+    void release() {
+        for (value_type* _c : _chunks) {
+            alloc_traits::deallocate(*this, _c, chunk_size);
+        }
+        _chunks.clear();
+        _used = 0; _end = nullptr; _chunk_end = nullptr; _free = nullptr; _size = 0;
+    }
+    /**
+     * @brief exchange the chunks and the allocators, the objects stay where they are
+     */
+    void swap(pool& _rhs) noexcept {
+        std::swap(static_cast<allocator_type&>(*this), static_cast<allocator_type&>(_rhs));
+        _chunks.swap(_rhs._chunks);
+        std::swap(_used, _rhs._used);
+        std::swap(_end, _rhs._end);
+        std::swap(_chunk_end, _rhs._chunk_end);
+        std::swap(_free, _rhs._free);
+        std::swap(_size, _rhs._size);
+    }
+private:
+    std::vector<value_type*, chunk_allocator_type> _chunks;
+    /// the number of chunks objects have been bumped from
+    size_t _used = 0;
+    value_type* _end = nullptr;
+    value_type* _chunk_end = nullptr;
+    value_type* _free = nullptr;
+    size_t _size = 0;
+};
+
+/**
+ * @brief allocate nodes and headers from pools, and link them by raw pointers
+ */
+template <typename _Tp, typename _Alloc> struct alloc<_Tp, _Alloc, pool_storage> : public _Alloc {
+    static constexpr bool bulk_release = true;
+    typedef node<_Tp, pool_storage> node_type;
+    typedef header<_Tp, pool_storage> header_type;
+    typedef node_type* node_pointer;
+    typedef header_type* header_pointer;
+    typedef typename node_type::value_type value_type;
+    typedef _Alloc elt_allocator_type;
+    typedef std::allocator_traits<elt_allocator_type> elt_alloc_traits;
+    typedef typename elt_alloc_traits::template rebind_alloc<node_type> node_allocator_type;
+    typedef typename elt_alloc_traits::template rebind_alloc<header_type> header_allocator_type;
+
+    alloc() = default;
+    /**
+     * @brief only the allocator is copied, the pools of `_rhs` are not shared
+     */
+    alloc(const alloc& _rhs) : _Alloc(_rhs), _node_pool(node_allocator_type(_rhs)), _header_pool(header_allocator_type(_rhs)) {}
+
+    elt_allocator_type& _M_get_elt_allocator() { return *static_cast<elt_allocator_type*>(this); }
+    const elt_allocator_type& _M_get_elt_allocator() const { return *static_cast<const elt_allocator_type*>(this); }
+
+    node_type& _M_node(node_pointer _p) const { return *_p; }
+    header_type& _M_header(header_pointer _p) const { return *_p; }
+
+    template <typename... _Args> node_pointer _M_allocate_node(_Args&&... _args) const {
+        return _node_pool.allocate(std::forward<_Args>(_args)...);
+    }
+    void _M_deallocate_node(node_pointer _p) const {
+        _node_pool.deallocate(_p);
+    }
+    template <typename... _Args> header_pointer _M_allocate_header(_Args&&... _args) const {
+        return _header_pool.allocate(std::forward<_Args>(_args)...);
+    }
+    void _M_deallocate_header(header_pointer _p) const {
+        _header_pool.deallocate(_p);
+    }
+    /**
+     * @brief run the destructor of the node, its slot is only reclaimed by `_M_release`
+     */
+    void _M_destroy_node(node_pointer _p) const {
+        std::destroy_at(_p);
+    }
+    /**
+     * @brief release every node and header at once, the nodes must have been destroyed
+     */
+    void _M_release() const {
+        _node_pool.release();
+        _header_pool.release();
+    }
+    void _M_reserve(size_t _nodes, size_t _headers) const {
+        _node_pool.reserve(_nodes);
+        _header_pool.reserve(_headers);
+    }
+    void _M_shrink_to_fit() const {
+        _node_pool.shrink_to_fit();
+        _header_pool.shrink_to_fit();
+    }
+    void _M_swap(alloc& _rhs) noexcept {
+        std::swap(_M_get_elt_allocator(), _rhs._M_get_elt_allocator());
+        _node_pool.swap(_rhs._node_pool);
+        _header_pool.swap(_rhs._header_pool);
+    }
+private:
+    mutable pool<node_type, node_allocator_type> _node_pool;
+    mutable pool<header_type, header_allocator_type> _header_pool;
+};
+
+/**
+ * @brief allocate nodes and headers from slabs, and link them by 32-bit indices
+ */
+template <typename _Tp, typename _Alloc> struct alloc<_Tp, _Alloc, index_storage> : public _Alloc {
+    static constexpr bool bulk_release = true;
+    typedef node<_Tp, index_storage> node_type;
+    typedef header<_Tp, index_storage> header_type;
+    typedef typename node_type::node_pointer node_pointer;
+    typedef typename node_type::header_pointer header_pointer;
+    typedef typename node_type::value_type value_type;
+    typedef _Alloc elt_allocator_type;
+    typedef std::allocator_traits<elt_allocator_type> elt_alloc_traits;
+    typedef typename elt_alloc_traits::template rebind_alloc<node_type> node_allocator_type;
+    typedef typename elt_alloc_traits::template rebind_alloc<header_type> header_allocator_type;
+
+    alloc() = default;
+    /**
+     * @brief only the allocator is copied, the slabs of `_rhs` are not shared
+     */
+    alloc(const alloc& _rhs) : _Alloc(_rhs), _node_slab(node_allocator_type(_rhs)), _header_slab(header_allocator_type(_rhs)) {}
+
+    elt_allocator_type& _M_get_elt_allocator() { return *static_cast<elt_allocator_type*>(this); }
+    const elt_allocator_type& _M_get_elt_allocator() const { return *static_cast<const elt_allocator_type*>(this); }
+
+    node_type& _M_node(node_pointer _p) const { return _node_slab[_p.index()]; }
+    header_type& _M_header(header_pointer _p) const { return _header_slab[_p.index()]; }
+
+    template <typename... _Args> node_pointer _M_allocate_node(_Args&&... _args) const {
+        return node_pointer(_node_slab.allocate(std::forward<_Args>(_args)...));
+    }
+    void _M_deallocate_node(node_pointer _p) const {
+        _node_slab.deallocate(_p.index());
+    }
+    template <typename... _Args> header_pointer _M_allocate_header(_Args&&... _args) const {
+        return header_pointer(_header_slab.allocate(std::forward<_Args>(_args)...));
+    }
+    void _M_deallocate_header(header_pointer _p) const {
+        _header_slab.deallocate(_p.index());
+    }
+    /**
+     * @brief run the destructor of the node, its slot is only reclaimed by `_M_release`
+     */
+    void _M_destroy_node(node_pointer _p) const {
+        std::destroy_at(std::addressof(_M_node(_p)));
+    }
+    /**
+     * @brief release every node and header at once, the nodes must have been destroyed
+     */
+    void _M_release() const {
+        _node_slab.release();
+        _header_slab.release();
+    }
+    void _M_reserve(size_t _nodes, size_t _headers) const {
+        _node_slab.reserve(_nodes);
+        _header_slab.reserve(_headers);
+    }
+    void _M_shrink_to_fit() const {
+        _node_slab.shrink_to_fit();
+        _header_slab.shrink_to_fit();
+    }
+    void _M_swap(alloc& _rhs) noexcept {
+        std::swap(_M_get_elt_allocator(), _rhs._M_get_elt_allocator());
+        _node_slab.swap(_rhs._node_slab);
+        _header_slab.swap(_rhs._header_slab);
+    }
+private:
+    mutable slab<node_type, node_allocator_type> _node_slab;
+    mutable slab<header_type, header_allocator_type> _header_slab;
+};
+
+/**
+ * @brief operations on the short trees, independent of how the links are stored
+ */
+template <typename _Tp, typename _Alloc, typename _Storage> struct forest : public alloc<_Tp, _Alloc, _Storage> {
+    using base = alloc<_Tp, _Alloc, _Storage>;
+    using node_type = typename base::node_type;
+    using header_type = typename base::header_type;
+    using node_pointer = typename base::node_pointer;
+    using header_pointer = typename base::header_pointer;
+    using size_type = typename header_type::size_type;
+
+    forest() = default;
+    forest(const forest& _rhs) : base(_rhs) {}
+
+    header_pointer _M_parent(node_pointer _n) const { return this->_M_node(_n)._header; }
+    header_pointer _M_parent(header_pointer _h) const { return this->_M_header(_h)._header; }
+    size_type _M_size(header_pointer _h) const { return this->_M_header(_h)._node_count; }
+    bool _M_empty(header_pointer _h) const { return this->_M_header(_h).empty(); }
+    void _M_prefetch(node_pointer _n) const { prefetch(std::addressof(this->_M_node(_n))); }
+    void _M_prefetch(header_pointer _h) const { prefetch(std::addressof(this->_M_header(_h))); }
+    node_pointer _M_left(node_pointer _n) const { return this->_M_node(_n)._left; }
+    header_pointer _M_left(header_pointer _h) const { return this->_M_header(_h)._left; }
+    /**
+     * @brief detach the node from its header
+     * @param _root the final header, whose node counter is decreased
+     * @return the previous header, which may become empty
+     */
+    auto _M_unhook(node_pointer _n, header_pointer _root) const -> header_pointer;
+    /**
+     * @brief detach the empty header from its parent
+     * @return the previous parent, which may become empty
+     */
+    auto _M_unhook(header_pointer _h) const -> header_pointer;
+    /**
+     * @brief move the header (with its subtree) under its grandparent
+     * @return the previous parent, which may become empty
+     */
+    auto _M_hoist(header_pointer _h) const -> header_pointer;
+    /**
+     * @brief attach the node to the final header @c _h
+     */
+    auto _M_append_node(header_pointer _h, node_pointer _n) const -> void;
+    /**
+     * @brief attach the final header @c _sub to the final header @c _h
+     */
+    auto _M_append_header(header_pointer _h, header_pointer _sub) const -> void;
+    /**
+     * @brief attach the detached node under the header @c _h right after @c _left, or first if @c _left is null
+     * @param _root the final header, whose node counter is increased
+     * @details the inverse of `_M_unhook(_n, _root)`
+     */
+    auto _M_insert_node_after(header_pointer _h, node_pointer _left, node_pointer _n, header_pointer _root) const -> void;
+    /**
+     * @brief attach the empty detached header under @c _p right after @c _left, or first if @c _left is null
+     */
+    auto _M_insert_header_after(header_pointer _p, header_pointer _left, header_pointer _h) const -> void;
+    /**
+     * @brief undo `_M_append_header(_h, _sub)`, @c _sub must be the last sub-header of the final header @c _h
+     * @details @c _sub becomes a final header again, but is not linked into the list of final headers
+     */
+    auto _M_detach_header(header_pointer _h, header_pointer _sub) const -> void;
+    /**
+     * @brief link the final header @c _h into the circular list of final headers starting at @c _first
+     * @details a final header has no siblings, so its `_left` and `_right` thread the list,
+     * the links of a listed header are never null, while a header fresh from the allocator has null links
+     */
+    auto _M_link_root(header_pointer& _first, header_pointer _h) const -> void;
+    /**
+     * @brief unlink the final header @c _h from the circular list of final headers starting at @c _first
+     */
+    auto _M_unlink_root(header_pointer& _first, header_pointer _h) const -> void;
+    bool _M_linked_root(header_pointer _h) const { return static_cast<bool>(this->_M_header(_h)._right); }
+    header_pointer _M_next_root(header_pointer _h) const { return this->_M_header(_h)._right; }
+    /**
+     * @brief visit each sub-header forward
+     * @tparam _Handler [](header_pointer){}
+     */
+    template <typename _Handler> auto _M_forward_headers(header_pointer _h, const _Handler& _hdr) const -> void;
+    /**
+     * @brief visit each sub-header backward
+     * @tparam _Handler [](header_pointer){}
+     */
+    template <typename _Handler> auto _M_backward_headers(header_pointer _h, const _Handler& _hdr) const -> void;
+    /**
+     * @brief visit each node of the header forward
+     * @tparam _Handler [](node_pointer){}
+     */
+    template <typename _Handler> auto _M_forward_nodes(header_pointer _h, const _Handler& _hdr) const -> void;
+    /**
+     * @brief visit each node of the header backward
+     * @tparam _Handler [](node_pointer){}
+     */
+    template <typename _Handler> auto _M_backward_nodes(header_pointer _h, const _Handler& _hdr) const -> void;
+    /**
+     * @brief return the first node of the tree of the final header @c _root in depth-first order
+     */
+    auto _M_first_node(header_pointer _root) const -> node_pointer;
+    /**
+     * @brief return the node following @c _n in depth-first order, or a null handle at the end of the tree of @c _root
+     */
+    auto _M_next_node(node_pointer _n, header_pointer _root) const -> node_pointer;
+    /**
+     * @brief return the header following @c _h in depth-first order, or a null handle at the end of the tree of @c _root
+     * @details the sibling links of @c _root thread the list of final headers, they are never followed
+     */
+    auto _M_next_header(header_pointer _h, header_pointer _root) const -> header_pointer;
+    auto _M_height(header_pointer _h) const -> size_t;
+    /**
+     * @brief check the links of the subtree
+     * @return the number of nodes in the subtree
+     */
+    auto _M_check(header_pointer _h) const -> size_t;
+};
+
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_unhook(node_pointer _p, header_pointer _root) const -> header_pointer {
+    node_type& _n = this->_M_node(_p);
+    header_type& _h = this->_M_header(_n._header);
+    assert(!this->_M_header(_root)._header);
+    if (_n._left) this->_M_node(_n._left)._right = _n._right;
+    else _h._first_node = _n._right; // _h._first_node == _p
+    if (_n._right) this->_M_node(_n._right)._left = _n._left;
+    else _h._last_node = _n._left; // _h._last_node == _p
+    --this->_M_header(_root)._node_count;
+    const header_pointer _prev = _n._header;
+    _n._left = {}; _n._right = {}; _n._header = {};
+    return _prev;
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_unhook(header_pointer _p) const -> header_pointer {
+    header_type& _h = this->_M_header(_p);
+    header_type& _parent = this->_M_header(_h._header);
+    assert(!_h._first && !_h._last);
+    assert(!_h._first_node && !_h._last_node);
+    if (_h._left) this->_M_header(_h._left)._right = _h._right;
+    else _parent._first = _h._right; // _parent._first == _p
+    if (_h._right) this->_M_header(_h._right)._left = _h._left;
+    else _parent._last = _h._left; // _parent._last == _p
+    const header_pointer _prev = _h._header;
+    _h._left = {}; _h._right = {}; _h._header = {};
+    return _prev;
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_hoist(header_pointer _p) const -> header_pointer {
+    header_type& _h = this->_M_header(_p);
+    const header_pointer _pp = _h._header;
+    header_type& _parent = this->_M_header(_pp);
+    const header_pointer _gp = _parent._header;
+    header_type& _grand = this->_M_header(_gp);
+    assert(_gp);
+    if (_h._left) this->_M_header(_h._left)._right = _h._right;
+    else _parent._first = _h._right; // _parent._first == _p
+    if (_h._right) this->_M_header(_h._right)._left = _h._left;
+    else _parent._last = _h._left; // _parent._last == _p
+    // the subtree stays in the same tree, so the counter of the final header is unchanged
+    if (!_grand._first) _grand._first = _p;
+    if (_grand._last) this->_M_header(_grand._last)._right = _p;
+    _h._left = _grand._last;
+    _h._right = {};
+    _grand._last = _p;
+    _h._header = _gp;
+    return _pp;
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_append_node(header_pointer _p, node_pointer _np) const -> void {
+    header_type& _h = this->_M_header(_p);
+    node_type& _n = this->_M_node(_np);
+    assert(!_h._header);
+    if (!_h._first_node) _h._first_node = _np;
+    if (_h._last_node) this->_M_node(_h._last_node)._right = _np;
+    _n._left = _h._last_node;
+    _h._last_node = _np;
+    _n._header = _p;
+    ++_h._node_count;
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_append_header(header_pointer _p, header_pointer _sp) const -> void {
+    header_type& _h = this->_M_header(_p);
+    header_type& _sub = this->_M_header(_sp);
+    assert(!_h._header);
+    if (!_h._first) _h._first = _sp;
+    if (_h._last) this->_M_header(_h._last)._right = _sp;
+    _sub._left = _h._last;
+    _h._last = _sp;
+    _sub._header = _p;
+    _h._node_count += _sub._node_count;
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_insert_node_after(header_pointer _p, node_pointer _lp, node_pointer _np, header_pointer _root) const -> void {
+    header_type& _h = this->_M_header(_p);
+    node_type& _n = this->_M_node(_np);
+    const node_pointer _rp = _lp ? this->_M_node(_lp)._right : _h._first_node;
+    if (_lp) this->_M_node(_lp)._right = _np;
+    else _h._first_node = _np;
+    if (_rp) this->_M_node(_rp)._left = _np;
+    else _h._last_node = _np;
+    _n._left = _lp; _n._right = _rp;
+    _n._header = _p;
+    ++this->_M_header(_root)._node_count;
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_insert_header_after(header_pointer _pp, header_pointer _lp, header_pointer _p) const -> void {
+    header_type& _parent = this->_M_header(_pp);
+    header_type& _h = this->_M_header(_p);
+    const header_pointer _rp = _lp ? this->_M_header(_lp)._right : _parent._first;
+    if (_lp) this->_M_header(_lp)._right = _p;
+    else _parent._first = _p;
+    if (_rp) this->_M_header(_rp)._left = _p;
+    else _parent._last = _p;
+    _h._left = _lp; _h._right = _rp;
+    _h._header = _pp;
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_detach_header(header_pointer _p, header_pointer _sp) const -> void {
+    header_type& _h = this->_M_header(_p);
+    header_type& _sub = this->_M_header(_sp);
+    assert(!_h._header && _h._last == _sp && _sub._header == _p);
+    _h._last = _sub._left;
+    if (_sub._left) this->_M_header(_sub._left)._right = {};
+    else _h._first = {};
+    _h._node_count -= _sub._node_count;
+    _sub._left = {}; _sub._header = {};
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_link_root(header_pointer& _first, header_pointer _p) const -> void {
+    header_type& _h = this->_M_header(_p);
+    assert(!_h._header && !_h._left && !_h._right);
+    if (!_first) {
+        _h._left = _p; _h._right = _p;
+        _first = _p;
+        return;
+    }
+    header_type& _f = this->_M_header(_first);
+    _h._left = _f._left; _h._right = _first;
+    this->_M_header(_f._left)._right = _p;
+    _f._left = _p;
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_unlink_root(header_pointer& _first, header_pointer _p) const -> void {
+    header_type& _h = this->_M_header(_p);
+    assert(!_h._header && _h._left && _h._right);
+    if (_h._right == _p) _first = {}; // the only final header
+    else {
+        this->_M_header(_h._left)._right = _h._right;
+        this->_M_header(_h._right)._left = _h._left;
+        if (_first == _p) _first = _h._right;
+    }
+    _h._left = {}; _h._right = {};
+}
+
+template <typename _Tp, typename _Alloc, typename _Storage> template <typename _Handler> auto
+forest<_Tp, _Alloc, _Storage>::_M_forward_headers(header_pointer _h, const _Handler& _hdr) const -> void {
+    for (header_pointer _i = this->_M_header(_h)._first; _i;) {
+        auto _prev = _i; _i = this->_M_header(_i)._right;
+        _hdr(_prev);
+    }
+}
+template <typename _Tp, typename _Alloc, typename _Storage> template <typename _Handler> auto
+forest<_Tp, _Alloc, _Storage>::_M_backward_headers(header_pointer _h, const _Handler& _hdr) const -> void {
+    for (header_pointer _i = this->_M_header(_h)._last; _i;) {
+        auto _prev = _i; _i = this->_M_header(_i)._left;
+        _hdr(_prev);
+    }
+}
+template <typename _Tp, typename _Alloc, typename _Storage> template <typename _Handler> auto
+forest<_Tp, _Alloc, _Storage>::_M_forward_nodes(header_pointer _h, const _Handler& _hdr) const -> void {
+    for (node_pointer _i = this->_M_header(_h)._first_node; _i;) {
+        auto _prev = _i; _i = this->_M_node(_i)._right;
+        _hdr(_prev);
+    }
+}
+template <typename _Tp, typename _Alloc, typename _Storage> template <typename _Handler> auto
+forest<_Tp, _Alloc, _Storage>::_M_backward_nodes(header_pointer _h, const _Handler& _hdr) const -> void {
+    for (node_pointer _i = this->_M_header(_h)._last_node; _i;) {
+        auto _prev = _i; _i = this->_M_node(_i)._left;
+        _hdr(_prev);
+    }
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_first_node(header_pointer _root) const -> node_pointer {
+    for (header_pointer _h = _root; _h; _h = _M_next_header(_h, _root)) {
+        if (this->_M_header(_h)._first_node) return this->_M_header(_h)._first_node;
+    }
+    return {};
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_next_node(node_pointer _n, header_pointer _root) const -> node_pointer {
+    const node_type& _node = this->_M_node(_n);
+    if (_node._right) return _node._right;
+    for (header_pointer _h = _M_next_header(_node._header, _root); _h; _h = _M_next_header(_h, _root)) {
+        if (this->_M_header(_h)._first_node) return this->_M_header(_h)._first_node;
+    }
+    return {};
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_next_header(header_pointer _h, header_pointer _root) const -> header_pointer {
+    if (this->_M_header(_h)._first) return this->_M_header(_h)._first;
+    for (; _h != _root; _h = this->_M_header(_h)._header) {
+        if (this->_M_header(_h)._right) return this->_M_header(_h)._right;
+    }
+    return {};
+}
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_height(header_pointer _h) const -> size_t {
+    size_t _height = 0ul;
+    for (header_pointer _i = this->_M_header(_h)._first; _i; _i = this->_M_header(_i)._right) {
+        const size_t _sub = _M_height(_i);
+        if (_sub > _height) _height = _sub;
+    }
+    return _height + 1;
+}
+
+static constexpr inline const char* fatal_node_range = "_first_node ^ _last_node";
+static constexpr inline const char* fatal_node_link = "invalid list<node>";
+static constexpr inline const char* fatal_node_header = "\\exists(list<node>)._header != this";
+static constexpr inline const char* fatal_header_range = "_first ^ _last";
+static constexpr inline const char* fatal_header_link = "invalid list<header>";
+static constexpr inline const char* fatal_header_header = "\\exists(list<header>)._header != this";
+static constexpr inline const char* fatal_header_empty = "\\exists(list<header>).empty()";
+
+template <typename _Tp, typename _Alloc, typename _Storage> auto
+forest<_Tp, _Alloc, _Storage>::_M_check(header_pointer _p) const -> size_t {
+    const header_type& _h = this->_M_header(_p);
+    size_t _count = 0ul;
+    // check node
+    if (!_h._first_node ^ !_h._last_node) throw std::logic_error(fatal_node_range);
+    node_pointer _prev_node {};
+    for (auto _i = _h._first_node; _i; _prev_node = _i, _i = this->_M_node(_i)._right) {
+        if (this->_M_node(_i)._left != _prev_node) throw std::logic_error(fatal_node_link);
+        if (this->_M_node(_i)._header != _p) throw std::logic_error(fatal_node_header);
+        ++_count;
+    }
+    // check sub-header
+    if (!_h._first ^ !_h._last) throw std::logic_error(fatal_header_range);
+    header_pointer _prev_header {};
+    for (auto _i = _h._first; _i; _prev_header = _i, _i = this->_M_header(_i)._right) {
+        if (this->_M_header(_i)._left != _prev_header) throw std::logic_error(fatal_header_link);
+        if (this->_M_header(_i)._header != _p) throw std::logic_error(fatal_header_header);
+        if (this->_M_header(_i).empty()) throw std::logic_error(fatal_header_empty);
+        _count += _M_check(_i);
+    }
+    return _count;
+}
+
+}
+
+namespace {
+/**
+ * @brief the lock-free union-find shared by the atomic forests, over the parent slots given by `_Forest::_M_slot`
+ * @details a root is always linked under the root of higher priority, a fixed pseudo random order of the indices
+ * (randomized linking), so no cycle can form and the trees stay shallow whatever the order of the unions;
+ * finds halve the path on the way, a failed halving is harmless, every operation is lock-free
+ */
+template <typename _Forest> struct atomic_links {
+    auto find(size_t _x) const -> size_t {
+        for (;;) {
+            size_t _p = _M_parent(_x).load(std::memory_order_acquire);
+            if (_p == _x) return _x;
+            const size_t _gp = _M_parent(_p).load(std::memory_order_acquire);
+            if (_gp != _p) _M_parent(_x).compare_exchange_weak(_p, _gp, std::memory_order_release, std::memory_order_relaxed);
+            _x = _gp;
+        }
+    }
+    /**
+     * @return whether @c _x and @c _y were apart, false when they are already united
+     */
+    auto unite(size_t _x, size_t _y) -> bool {
+        for (;;) {
+            _x = find(_x); _y = find(_y);
+            if (_x == _y) return false;
+            if (_M_priority(_x) > _M_priority(_y)) std::swap(_x, _y);
+            // fails when another thread has linked `_x` meanwhile, then retry from the new roots
+            size_t _root = _x;
+            if (_M_parent(_x).compare_exchange_strong(_root, _y, std::memory_order_acq_rel, std::memory_order_acquire)) return true;
+        }
+    }
+    /**
+     * @details linearizable: when the roots differ, they were apart as long as the first one is still a root
+     */
+    auto same(size_t _x, size_t _y) const -> bool {
+        for (;;) {
+            _x = find(_x); _y = find(_y);
+            if (_x == _y) return true;
+            if (_M_parent(_x).load(std::memory_order_acquire) == _x) return false;
+        }
+    }
+private:
+    auto _M_parent(size_t _x) const -> std::atomic<size_t>& { return static_cast<const _Forest*>(this)->_M_slot(_x); }
+    /// an odd multiplier is a bijection of the indices, so the priorities never tie
+    static auto _M_priority(size_t _x) -> size_t { return _x * static_cast<size_t>(0x9e3779b97f4a7c15ull); }
+};
+/**
+ * @brief union-find over the indices [0, n), roots are linked by compare-and-swap so that threads may unite concurrently
+ */
+struct atomic_forest : public atomic_links<atomic_forest> {
+    explicit atomic_forest(size_t _n) : _parent(std::make_unique<std::atomic<size_t>[]>(_n)), _size(_n) {
+        for (size_t _i = 0; _i != _n; ++_i) _parent[_i].store(_i, std::memory_order_relaxed);
+    }
+    auto size() const -> size_t { return _size; }
+private:
+    friend struct atomic_links<atomic_forest>;
+    auto _M_slot(size_t _x) const -> std::atomic<size_t>& { return _parent[_x]; }
+private:
+    std::unique_ptr<std::atomic<size_t>[]> _parent;
+    size_t _size;
+};
+/**
+ * @brief growable union-find over the indices [0, size()), lock-free as `atomic_forest`, and indices may be opened
+ * while other threads unite and find
+ * @details the slots live in blocks of doubling size that are never moved, a block is installed by compare-and-swap
+ * by the first index opened in it; an index is only reachable through `open` or a link, both published after its slot
+ */
+struct link_forest : public atomic_links<link_forest> {
+    link_forest() = default;
+    link_forest(const link_forest&) = delete;
+    auto operator=(const link_forest&) -> link_forest& = delete;
+    ~link_forest() {
+        for (size_t _b = 0; _b != _blocks.size(); ++_b) delete[] _blocks[_b].load(std::memory_order_relaxed);
+    }
+    auto size() const -> size_t { return _next.load(std::memory_order_acquire); }
+    /**
+     * @brief add a new index in a set of its own
+     */
+    auto open() -> size_t {
+        const size_t _x = _next.fetch_add(1, std::memory_order_relaxed);
+        const auto [_b, _i] = _M_locate(_x);
+        std::atomic<size_t>* _block = _blocks[_b].load(std::memory_order_acquire);
+        if (_block == nullptr) {
+            std::atomic<size_t>* _fresh = new std::atomic<size_t>[_first_block << _b];
+            if (_blocks[_b].compare_exchange_strong(_block, _fresh, std::memory_order_acq_rel, std::memory_order_acquire)) _block = _fresh;
+            else delete[] _fresh;
+        }
+        _block[_i].store(_x, std::memory_order_release);
+        return _x;
+    }
+private:
+    friend struct atomic_links<link_forest>;
+    static constexpr size_t _first_block = 64;
+    /**
+     * @return the block of the index, and its offset there; block b holds the indices [64 (2^b - 1), 64 (2^(b+1) - 1))
+     */
+    static auto _M_locate(size_t _x) -> std::pair<size_t, size_t> {
+        const size_t _y = _x + _first_block;
+        const size_t _b = std::bit_width(_y) - std::bit_width(_first_block);
+        return {_b, _y - (_first_block << _b)};
+    }
+    auto _M_slot(size_t _x) const -> std::atomic<size_t>& {
+        const auto [_b, _i] = _M_locate(_x);
+        return _blocks[_b].load(std::memory_order_acquire)[_i];
+    }
+private:
+    std::array<std::atomic<std::atomic<size_t>*>, std::numeric_limits<size_t>::digits - 6> _blocks {};
+    std::atomic<size_t> _next {0};
+};
+/**
+ * @brief union-find over the indices [0, size()) remembering every version, partially persistent by version stamps
+ * @details a link is never undone, an index records the version it was linked in, so the tree of a past version is
+ * the current tree cut at the links made after it; no path is compressed, the links are made by the current weight
+ * (the number of indices in the tree), so every past tree is o(log n) high as well; the number of members of a root
+ * is recorded per version, only when it changes
+ */
+struct versioned_forest {
+    using version_type = size_t;
+    static constexpr version_type never = static_cast<version_type>(-1);
+    auto size() const -> size_t { return _parent.size(); }
+    /**
+     * @brief add a new index in a set of its own, with 1 member
+     */
+    auto open() -> size_t {
+        _parent.push_back(_parent.size());
+        _linked.push_back(never);
+        _weight.push_back(1);
+        _members.emplace_back();
+        return _parent.size() - 1;
+    }
     /**
-     * @brief visit each header forward
-     * @tparam _Handler [](header_type*){}
+     * @brief return the root of @c _x as of the version @c _v
      */
-    template <typename _Handler> void forward_headers(const _Handler& _hdr);
+    auto find(size_t _x, version_type _v) const -> size_t {
+        for (; _linked[_x] <= _v; _x = _parent[_x]);
+        return _x;
+    }
     /**
-     * @brief visit each header backward
-     * @tparam _Handler [](header_type*){}
+     * @brief link the current root @c _y under the current root @c _x in the version @c _v
+     * @return the root absorbing the other one, the heavier one
      */
-    template <typename _Handler> void backward_headers(const _Handler& _hdr);
+    auto link(size_t _x, size_t _y, version_type _v) -> size_t {
+        if (_weight[_x] < _weight[_y]) std::swap(_x, _y);
+        _parent[_y] = _x;
+        _linked[_y] = _v;
+        _weight[_x] += _weight[_y];
+        return _x;
+    }
     /**
-     * @brief visit each node forward
-     * @tparam _Handler [](node_type*){}
+     * @brief return the number of members of the root @c _r as of the version @c _v
      */
-    template <typename _Handler> void forward_nodes(const _Handler& _hdr);
+    auto members(size_t _r, version_type _v) const -> size_t {
+        const auto& _log = _members[_r];
+        auto _i = std::upper_bound(_log.begin(), _log.end(), _v, [](version_type _v, const auto& _e) { return _v < _e.first; });
+        return _i == _log.begin() ? 1 : std::prev(_i)->second;
+    }
     /**
-     * @brief visit each node backward
-     * @tparam _Handler [](node_type*){}
+     * @brief set the number of members of the root @c _r in the latest version @c _v
      */
-    template <typename _Handler> void backward_nodes(const _Handler& _hdr);
-    void check() const;
-private:
-    self* _header = nullptr;
-    self* _left = nullptr;
-    self* _right = nullptr;
-    self* _first = nullptr;
-    self* _last = nullptr;
-    node_type* _first_node = nullptr;
-    node_type* _last_node = nullptr;
-    size_t _node_count = 0ul;
-};
-
-template <typename _Tp> auto node<_Tp>::unhook() -> header_type* {
-    if (_left != nullptr) _left->_right = _right;
-    else _header->_first_node = _right; // _header->_first == this
-    if (_right != nullptr) _right->_left = _left;
-    else _header->_last_node = _left; // _header->_last == this
-    for (auto* _i = _header; _i != nullptr; _i = _i->_header) {
-        --_i->_node_count;
-    }
-    header_type* _h = _header;
-    _left = nullptr; _right = nullptr; _header = nullptr;
-    return _h;
-};
-template <typename _Tp> auto header<_Tp>::unhook() -> self* {
-    assert(_first == nullptr && _last == nullptr);
-    assert(_first_node == nullptr && _last_node == nullptr);
-    assert(_node_count == 0ul);
-    if (_left != nullptr) _left->_right = _right;
-    else _header->_first = _right; // _header->_first == this
-    if (_right != nullptr) _right->_left = _left;
-    else _header->_last = _left; // _header->_last == this
-    self* _h = _header;
-    _left = nullptr; _right = nullptr; _header = nullptr;
-    return _h;
-};
-template <typename _Tp> auto header<_Tp>::append_node(node_type* _n) -> void {
-    if (_first_node == nullptr) _first_node = _n;
-    if (_last_node != nullptr) _last_node->_right = _n;
-    _n->_left = _last_node;
-    _last_node = _n;
-    _n->_header = this;
-    for (auto* _i = this; _i != nullptr; _i = _i->_header) {
-        ++_i->_node_count;
+    auto set_members(size_t _r, version_type _v, size_t _n) -> void {
+        auto& _log = _members[_r];
+        if (!_log.empty() && _log.back().first == _v) _log.back().second = _n;
+        else _log.emplace_back(_v, _n);
     }
+private:
+    std::vector<size_t> _parent;
+    std::vector<version_type> _linked;
+    std::vector<size_t> _weight;
+    std::vector<std::vector<std::pair<version_type, size_t>>> _members;
 };
-template <typename _Tp> auto header<_Tp>::append_header(self* _h) -> void {
-    if (_first == nullptr) _first = _h;
-    if (_last != nullptr) _last->_right = _h;
-    _h->_left = _last;
-    _last = _h;
-    _h->_header = this;
-    for (auto* _i = this; _i != nullptr; _i = _i->_header) {
-        _i->_node_count += _h->_node_count;
+/**
+ * @brief lock-free ring of a power of 2 capacity, for one producer thread and one consumer thread
+ */
+template <typename _Tp> struct spsc_ring {
+    explicit spsc_ring(size_t _capacity) : _slots(new _Tp[_capacity]), _mask(_capacity - 1) {}
+    /**
+     * @return false when the ring is full, nothing is pushed then
+     */
+    auto push(const _Tp& _v) -> bool {
+        const size_t _t = _tail.load(std::memory_order_relaxed);
+        if (_t - _head.load(std::memory_order_acquire) > _mask) return false;
+        _slots[_t & _mask] = _v;
+        _tail.store(_t + 1, std::memory_order_release);
+        return true;
     }
-};
-
-template <typename _Tp> template <typename _Handler> auto header<_Tp>::forward_headers(const _Handler& _hdr) -> void {
-    for (self* _i = _first; _i != nullptr;) {
-        auto* _prev = _i; _i = _i->_right;
-        _hdr(_prev);
+    /**
+     * @brief the free slots, as seen by the producer
+     */
+    auto room() const -> size_t {
+        return _mask + 1 - (_tail.load(std::memory_order_relaxed) - _head.load(std::memory_order_acquire));
     }
-}
-template <typename _Tp> template <typename _Handler> auto header<_Tp>::backward_headers(const _Handler& _hdr) -> void {
-    for (self* _i = _last; _i != nullptr;) {
-        auto* _prev = _i; _i = _i->_left;
-        _hdr(_prev);
+    /**
+     * @return false when the ring is empty
+     */
+    auto pop(_Tp& _v) -> bool {
+        const size_t _h = _head.load(std::memory_order_relaxed);
+        if (_h == _tail.load(std::memory_order_acquire)) return false;
+        _v = std::move(_slots[_h & _mask]);
+        _head.store(_h + 1, std::memory_order_release);
+        return true;
     }
+private:
+    alignas(64) std::atomic<size_t> _head {0};
+    alignas(64) std::atomic<size_t> _tail {0};
+    std::unique_ptr<_Tp[]> _slots;
+    size_t _mask;
+};
+/**
+ * @brief leading block of a file written by `save`, all in native byte order
+ * @details the sections follow, each one padded to 8 bytes: the classification of each key, the size of each
+ * classification, the keys, the hash slots of the keys, the values; the hash slots are written only for
+ * trivially copyable keys, a slot holds the position of a key plus one, 0 when empty, and is probed linearly;
+ * the classifications, the sizes and the slots are `archive_index`
+ */
+struct archive_header {
+    static constexpr char signature[8] = {'i', 'c', 'y', '.', 'd', 's', 'j', '1'};
+    char _signature[8];
+    /// `sizeof` of a trivially copyable key or value, which is then read in place, 0 for a serialized one
+    uint64_t _key_size;
+    uint64_t _value_size;
+    /// whether the values follow, written by `disjoint_map`
+    uint64_t _values;
+    uint64_t _size;
+    uint64_t _classes;
+    uint64_t _slots;
+};
+using archive_index = uint32_t;
+template <typename _Tp> constexpr uint64_t archive_size = std::is_trivially_copyable_v<_Tp> ? sizeof(_Tp) : 0;
+inline auto archive_align(uint64_t _n) -> uint64_t { return (_n + 7) & ~static_cast<uint64_t>(7); }
+inline auto archive_pad(std::ostream& _out) -> void {
+    const uint64_t _at = static_cast<uint64_t>(_out.tellp());
+    static constexpr char _zeros[8] {};
+    _out.write(_zeros, archive_align(_at) - _at);
 }
-template <typename _Tp> template <typename _Handler> auto header<_Tp>::forward_nodes(const _Handler& _hdr) -> void {
-    for (node_type* _i = _first_node; _i != nullptr;) {
-        auto* _prev = _i; _i = _i->_right;
-        _hdr(_prev);
-    }
+inline auto archive_skip_pad(std::istream& _in) -> void {
+    const uint64_t _at = static_cast<uint64_t>(_in.tellg());
+    _in.seekg(archive_align(_at) - _at, std::ios::cur);
 }
-template <typename _Tp> template <typename _Handler> auto header<_Tp>::backward_nodes(const _Handler& _hdr) -> void {
-    for (node_type* _i = _last_node; _i != nullptr;) {
-        auto* _prev = _i; _i = _i->_left;
-        _hdr(_prev);
-    }
+/**
+ * @brief return the number of hash slots for @c _n keys, twice as many, rounded up to a power of 2
+ */
+inline auto archive_capacity(uint64_t _n) -> uint64_t { return std::bit_ceil(std::max<uint64_t>(2 * _n, 1)); }
+/**
+ * @brief put the key at @c _position into the first free slot from its hash
+ */
+template <typename _Hash, typename _Key> auto archive_slot(std::vector<archive_index>& _slots, const _Key& _k, uint64_t _position) -> void {
+    const size_t _mask = _slots.size() - 1;
+    size_t _s = _Hash()(_k) & _mask;
+    for (; _slots[_s] != 0; _s = (_s + 1) & _mask);
+    _slots[_s] = _position + 1;
 }
-
-static constexpr inline const char* fatal_node_range = "_first_node ^ _last_node";
-static constexpr inline const char* fatal_node_link = "invalid list<node>";
-static constexpr inline const char* fatal_node_header = "\\exists(list<node>)._header != this";
-static constexpr inline const char* fatal_header_range = "_first ^ _last";
-static constexpr inline const char* fatal_header_link = "invalid list<header>";
-static constexpr inline const char* fatal_header_header = "\\exists(list<header>)._header != this";
-static constexpr inline const char* fatal_node_count = "\\sum(\\all(list<header>).size()) != size()";
-
-template <typename _Tp> auto header<_Tp>::check() const -> void {
-    size_t _count = 0ul;
-    // check node
-    if (_first_node == nullptr ^ _last_node == nullptr) throw std::logic_error(fatal_node_range);
-    node_type* _prev_node = nullptr;
-    for (auto* _i = _first_node; _i != nullptr; _prev_node = _i, _i = _i->_right) {
-        if (_i->_left != _prev_node) throw std::logic_error(fatal_node_link);
-        if (_i->_header != this) throw std::logic_error(fatal_node_header);
-        ++_count;
-    }
-    // check sub-header
-    if (_first == nullptr ^ _last == nullptr) throw std::logic_error(fatal_header_range);
-    self* _prev_header = nullptr;
-    for (auto* _i = _first; _i != nullptr; _prev_header = _i, _i = _i->_right) {
-        if (_i->_left != _prev_header) throw std::logic_error(fatal_header_link);
-        if (_i->_header != this) throw std::logic_error(fatal_header_header);
-        _i->check();
-        _count += _i->_node_count;
-    }
-    if (_count != _node_count) throw std::logic_error(fatal_node_count);
-    return;
+/**
+ * @brief payload of the nodes, the value together with the key handle when the key policy asks for it
+ */
+template <typename _Key, typename _Value, typename _Policy> using node_payload = std::conditional_t<_Policy::key_policy::keyed,
+    keyed<_Value, typename _Policy::dictionary_policy::template key_handle<_Key>>, _Value
+>;
+/**
+ * @brief what a member of a classification reads as, the key, or the key and the value
+ */
+template <typename _Key, typename _Value> struct member_traits {
+    using reference = std::pair<const _Key&, const _Value&>;
+    using value_type = reference;
 };
-
-template <typename _Tp, typename _Alloc> struct alloc : public _Alloc {
-    typedef node<_Tp> node_type;
-    typedef header<_Tp> header_type;
-    typedef typename node_type::value_type value_type;
-    typedef _Alloc elt_allocator_type;
-    typedef std::allocator_traits<elt_allocator_type> elt_alloc_traits;
-    typedef typename elt_alloc_traits::template rebind_alloc<node_type> node_allocator_type;
-    typedef std::allocator_traits<node_allocator_type> node_alloc_traits;
-    typedef typename elt_alloc_traits::template rebind_alloc<header_type> header_allocator_type;
-    typedef std::allocator_traits<header_allocator_type> header_alloc_traits;
-
-    elt_allocator_type& _M_get_elt_allocator() { return *static_cast<elt_allocator_type*>(this); }
-    const elt_allocator_type& _M_get_elt_allocator() const { return *static_cast<const elt_allocator_type*>(this); }
-    node_allocator_type _M_get_node_allocator() const { return node_allocator_type(_M_get_elt_allocator()); }
-    header_allocator_type _M_get_header_allocator() const { return header_allocator_type(_M_get_elt_allocator()); }
-
-    template <typename... _Args> node_type* _M_allocate_node(_Args&&... _args) const {
-        node_allocator_type _node_alloc = _M_get_node_allocator();
-        auto _ptr = node_alloc_traits::allocate(_node_alloc, 1);
-        node_type* _p = std::addressof(*_ptr);
-        node_alloc_traits::construct(_node_alloc, _p, std::forward<_Args>(_args)...);
-        return _p;
-    }
-    void _M_deallocate_node(node_type* _p) const {
-        node_allocator_type _node_alloc = _M_get_node_allocator();
-        node_alloc_traits::destroy(_node_alloc, _p);
-        node_alloc_traits::deallocate(_node_alloc, _p, 1);
-    }
-    template <typename... _Args> header_type* _M_allocate_header(_Args&&... _args) const {
-        header_allocator_type _header_alloc = _M_get_header_allocator();
-        auto _ptr = header_alloc_traits::allocate(_header_alloc, 1);
-        header_type* _p = std::addressof(*_ptr);
-        header_alloc_traits::construct(_header_alloc, _p, std::forward<_Args>(_args)...);
-        return _p;
-    }
-    void _M_deallocate_header(header_type* _p) const {
-        header_allocator_type _header_alloc = _M_get_header_allocator();
-        header_alloc_traits::destroy(_header_alloc, _p);
-        header_alloc_traits::deallocate(_header_alloc, _p, 1);
-    }
+template <typename _Key> struct member_traits<_Key, void> {
+    using reference = const _Key&;
+    using value_type = _Key;
 };
-
-}
-
-namespace {
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc>
-struct disjoint_base : public alloc<_Value, _Alloc> {
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy>
+struct disjoint_base : public forest<node_payload<_Key, _Value, _Policy>, _Alloc, typename _Policy::storage_policy> {
 public:
-    using base = alloc<_Value, _Alloc>;
-    using self = disjoint_base<_Key, _Value, _Hash, _Alloc>;
+    using base = forest<node_payload<_Key, _Value, _Policy>, _Alloc, typename _Policy::storage_policy>;
+    using self = disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>;
     using node_type = typename base::node_type;
     using header_type = typename base::header_type;
+    using node_pointer = typename base::node_pointer;
+    using header_pointer = typename base::header_pointer;
     using key_type = _Key;
+    using policy_type = _Policy;
+    using merge_policy = typename policy_type::merge_policy;
+    using compress_policy = typename policy_type::compress_policy;
+    using key_policy = typename policy_type::key_policy;
+    using feed_policy = typename policy_type::feed_policy;
+    using dictionary_type = typename policy_type::dictionary_policy::template type<key_type, node_pointer, _Hash>;
+    /**
+     * @brief forward iterator over the members of a classification, depth first through its tree
+     * @details any modification of the container, and any compressing lookup such as `sibling`, invalidates it
+     */
+    struct member_iterator {
+        using value_type = typename member_traits<key_type, _Value>::value_type;
+        using reference = typename member_traits<key_type, _Value>::reference;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        auto operator*() const -> reference { return _c->_M_member(_n); }
+        auto operator++() -> member_iterator& { _n = _c->_M_next_node(_n, _root); return *this; }
+        auto operator++(int) -> member_iterator { member_iterator _i = *this; ++*this; return _i; }
+        friend auto operator==(const member_iterator& _x, const member_iterator& _y) -> bool { return _x._n == _y._n; }
+        const self* _c = nullptr;
+        header_pointer _root {};
+        node_pointer _n {};
+    };
+    using member_range = std::ranges::subrange<member_iterator, member_iterator, std::ranges::subrange_kind::sized>;
+    /**
+     * @brief forward iterator over the classifications, each one read as the range of its members
+     */
+    struct class_iterator {
+        using value_type = member_range;
+        using reference = member_range;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        auto operator*() const -> reference { return _c->_M_members(_h); }
+        auto operator++() -> class_iterator& { _h = _c->_M_next_root(_h); --_left; return *this; }
+        auto operator++(int) -> class_iterator { class_iterator _i = *this; ++*this; return _i; }
+        friend auto operator==(const class_iterator& _x, const class_iterator& _y) -> bool { return _x._left == _y._left; }
+        const self* _c = nullptr;
+        header_pointer _h {};
+        size_t _left = 0;
+    };
+    using class_range = std::ranges::subrange<class_iterator, class_iterator, std::ranges::subrange_kind::sized>;
+    /**
+     * @brief identity of a classification, its final header, a null handle for an absent key
+     * @details only valid until the next modification of the container
+     */
+    using class_id = header_pointer;
+    /// the number of lookups interleaved by the batched queries
+    static constexpr size_t batch_group = 16;
+    /// whether `checkpoint` and `rollback` are available, lookups must not restructure the trees behind the undo log
+    static constexpr bool reversible = !compress_policy::node && !compress_policy::path;
+    /**
+     * @brief a point to return to by `rollback`, the position in the undo log of an epoch ended by `commit`
+     * @details @c _generation counts the rollbacks before it, a later rollback below @c _size discards it
+     */
+    struct checkpoint_type {
+        size_t _epoch;
+        size_t _generation;
+        size_t _size;
+    };
+    /// whether the changes are reported, by `feed_policy`
+    static constexpr bool feeding = feed_policy::capacity != 0;
+    /**
+     * @brief a change of the classifications, taken by `poll`
+     * @details `merged`: the root @c _from was absorbed by the root @c _to;
+     * `moved`: the key @c _key left the classification @c _from for @c _to, @c _from is null for an added key,
+     * and @c _to is null for a deleted key;
+     * `deleted_class`: the classification @c _from is gone with all of its keys, its id may be reused by later changes;
+     * `reset`: changes were dropped on a full ring, or the contents were replaced, the consumer has to start over
+     */
+    struct change_type {
+        enum kind_type : uint8_t { merged, moved, deleted_class, reset };
+        kind_type _kind;
+        class_id _from {};
+        class_id _to {};
+        key_type _key {};
+    };
 public:
     disjoint_base() = default;
     disjoint_base(const self& _rhs) : base(_rhs) {};
+    /**
+     * @brief steal the nodes, the headers and the storage of @c _rhs, which is left empty
+     * @details the ring of a feed is taken over too, the moved-from container reports nothing more
+     */
+    disjoint_base(self&& _rhs) noexcept : _feed(std::move(_rhs._feed)) { swap(_rhs); }
     virtual ~disjoint_base();
 public:/**
      * @brief return whether the specific key in disjoint set
      * @param _k the specific key
      */
-    auto contains(const key_type& _k) const -> bool { return _nodes.count(_k) != 0; }
+    auto contains(const key_type& _k) const -> bool { return _nodes.contains(_k); }
     /**
      * @brief return the number of elements classification
      */
-    auto classification() const -> size_t { return _final_headers.size(); }
+    auto classification() const -> size_t { return _final_header_count; }
     /**
      * @brief return the number of elements
      */
@@ -293,6 +1852,28 @@ public:/**
      * @param _y the given key
      */
     auto sibling(const key_type& _x, const key_type& _y) const -> bool;
+    /**
+     * @brief return the classification of the specific key, a null handle when the key is not in disjoint set
+     * @details the path is compressed as by `sibling`
+     */
+    auto find(const key_type& _k) const -> class_id;
+    /**
+     * @brief write the classification of each key to @c _out, as `class_id`
+     * @return the output iterator past the last written id
+     * @details the lookups are interleaved in groups of `batch_group`: the dictionary slots, the nodes
+     * and the headers of a group are prefetched level by level, so that their cache misses overlap,
+     * the paths are compressed as by `sibling`
+     */
+    template <std::ranges::forward_range _Keys, std::output_iterator<class_id> _Out>
+    auto find_batch(const _Keys& _keys, _Out _out) const -> _Out;
+    /**
+     * @brief write `sibling(x, y)` of each pair of keys to @c _out
+     * @param _pairs pairs of keys read by `std::get<0>` and `std::get<1>`
+     * @return the output iterator past the last written result
+     * @details interleaved as `find_batch`
+     */
+    template <std::ranges::forward_range _Pairs, std::output_iterator<bool> _Out>
+    auto sibling_batch(const _Pairs& _pairs, _Out _out) const -> _Out;
     /**
      * @brief delete the specific key
      * @param _k the specific key
@@ -331,6 +1912,23 @@ public:/**
      * @return return false when the keys are not in disjoint set or the classifications fail to be merged
      */
     auto merge(const key_type& _x, const key_type& _y) -> bool;
+    /**
+     * @brief merge 2 classifications given by `find`, without looking up any key
+     * @return the root of the merged classification, one of @c _x and @c _y
+     * @pre both are current classifications of this container
+     */
+    auto unite(class_id _x, class_id _y) -> class_id;
+    /**
+     * @brief merge the classifications of each pair of keys, as `merge` one pair after another
+     * @param _pairs pairs of keys read by `std::get<0>` and `std::get<1>`, pairs with absent keys are ignored
+     * @return the number of classifications absorbed, by which `classification()` decreases
+     * @details the pairs are taken `batch_group / 2` at a time: their roots are looked up interleaved as
+     * `find_batch`, and united on a scratch union-find, pairs of already connected roots cost nothing more;
+     * each scratch set picks its root by the merge policy on the accumulated sizes, as a sequence of `merge` would,
+     * then every other distinct root of the set is appended to it directly, so each absorbed root is unlinked once
+     */
+    template <std::ranges::forward_range _Pairs>
+    auto merge_batch(const _Pairs& _pairs) -> size_t;
     /**
      * @brief return whether no element in the disjoint set
      */
@@ -339,205 +1937,884 @@ public:/**
      * @brief clear all keys and classifications
      */
     auto clear() -> void;
+    /**
+     * @brief pre-size the node dictionary and the node and header storage
+     * @param _n_keys the number of keys to be held
+     * @param _n_classes_hint the expected number of headers, every `add(k)` and `join(k)` creates one
+     * @details the final headers are linked intrusively and need no room
+     */
+    auto reserve(size_t _n_keys, size_t _n_classes_hint) -> void;
+    auto reserve(size_t _n_keys) -> void { reserve(_n_keys, _n_keys); }
+    /**
+     * @brief return the unused capacity of the node dictionary and of the storage
+     * @details chunks of pooled storage are returned only when none of their objects is alive
+     */
+    auto shrink_to_fit() -> void;
+    /**
+     * @brief exchange the contents in o(1), the allocators are exchanged as well
+     */
+    auto swap(self& _rhs) noexcept -> void;
+    /**
+     * @brief flatten every classification, all nodes are moved to their root headers and the emptied headers are released
+     * @details the maintenance of `compress_none`, that a writer schedules, o(size()) amortized
+     */
+    auto compress() -> void;
+    /**
+     * @brief compress the path of the specific key, as a lookup does under `compress_path`
+     * @param _k the specific key
+     * @return return false when the key is not in disjoint set
+     */
+    auto compress(const key_type& _k) -> bool;
+    /**
+     * @brief start logging the modifications if not yet, and return the current point of the undo log
+     * @details checkpoints nest, rolling back to one discards the later ones but keeps itself
+     */
+    auto checkpoint() -> checkpoint_type requires reversible;
+    /**
+     * @brief undo every modification since the checkpoint, newest first
+     * @details the trees, the final headers and the handles are restored exactly, the removed nodes and headers
+     * are kept by the log rather than released, so nothing is allocated again but the entries of the dictionary;
+     * values modified in place are not restored, `del_all`, `del_except`, `clear` and `compress` commit first;
+     * a feed reports the undone modifications as a single `reset`; throw `std::logic_error` when the checkpoint was discarded
+     */
+    auto rollback(const checkpoint_type& _c) -> void requires reversible;
+    /**
+     * @brief discard the undo log and every checkpoint, release the nodes and headers it kept, and stop logging
+     */
+    auto commit() -> void requires reversible { _M_forget(); }
+    /**
+     * @brief take the oldest change not taken yet
+     * @return false when there is none
+     * @details lock-free, one consumer thread may poll while the container is modified,
+     * but not while it is swapped, moved or destroyed; the contents replaced at once, by a copy, an assignment,
+     * `clear`, `swap`, `rollback`, `load` or `from_edges`, are reported as a `reset`
+     */
+    auto poll(change_type& _c) const -> bool requires feeding { return _feed._ring && _feed._ring->pop(_c); }
+    /**
+     * @brief return the members of the classification containing the specific key, lazily read from its tree
+     * @param _k the specific key
+     * @return an empty range when the key is not in disjoint set
+     * @details the keys are read through the key handles of the nodes, so the nodes must be keyed,
+     * walking the range costs o(size of the classification)
+     */
+    auto members(const key_type& _k) const -> member_range requires key_policy::keyed;
+    /**
+     * @brief return all classifications, each one as the range of its members
+     */
+    auto classes() const -> class_range requires key_policy::keyed {
+        return {class_iterator{this, _final_headers, _final_header_count}, class_iterator{this, {}, 0}, _final_header_count};
+    }
+    /**
+     * @brief write the keys, the classifications and the values to a binary file, read back by `load`
+     * @details the layout is `archive_header` and its sections, keys and values are written by `serializer`;
+     * for trivially copyable keys the hash slots by @c _Hash are written too, so that `mapped_disjoint_set`
+     * answers from the mapped file; throw `std::runtime_error` when the file cannot be written
+     */
+    auto save(const std::filesystem::path& _path) const -> void;
 
 // check function
     auto check() const -> void;
+    /**
+     * @brief return the maximum height of the short trees
+     */
+    auto height() const -> size_t;
 protected:
     /**
      * @brief update final headers information
      * @param _h a final header
     */
-    auto _M_update_final_headers(header_type* const _h) -> void;
+    auto _M_update_final_headers(header_pointer const _h) -> void;
+    auto _M_link_final_header(header_pointer const _h) -> void;
+    auto _M_unlink_final_header(header_pointer const _h) -> void;
+    /**
+     * @brief visit each final header, the visited header may be deallocated by the handler
+     * @tparam _Handler [](header_pointer){}
+     */
+    template <typename _Handler> auto _M_for_each_final_header(const _Handler& _hdr) const -> void;
+    /**
+     * @brief allocate the header of a detached node that starts a classification alone
+     * @details the node is deallocated if the allocation throws
+     */
+    auto _M_allocate_alone_header(node_pointer const _n) -> header_pointer;
+    /**
+     * @brief register the detached node in the node dictionary, and hand it the key handle if nodes are keyed
+     * @param _alone the header allocated beforehand for the node alone, deallocated as well if the dictionary throws
+     * @details the node is deallocated if the dictionary throws
+     */
+    auto _M_insert_node(const key_type& _k, node_pointer const _n, header_pointer const _alone = {}) -> void;
+    /**
+     * @brief erase every node of the tree from the node dictionary, and deallocate the nodes and the headers
+     * @details only for keyed nodes, the key of each node is found through its handle
+     */
+    auto _M_erase_tree(header_pointer const _h) -> void;
     /**
      * @brief return the root header
-     * @details compress _n
+     * @details compress _n (and the path to the root header) according to compress_policy
      */
-    auto _M_final_header(node_type* const _n) const -> header_type*;
+    template <typename _Compress = compress_policy>
+    auto _M_final_header(node_pointer const _n) const -> header_pointer;
     /**
      * @brief return the root header
      * @details not compress _n
      */
-    auto _M_final_header_const(node_type* const _n) const -> header_type*;
+    auto _M_final_header_const(node_pointer const _n) const -> header_pointer;
+    /**
+     * @brief find the final headers of @c _g nodes at once, each level of the paths is prefetched for all of them
+     * @param _n the nodes, null handles are allowed
+     * @param _h the final headers, null for null nodes
+     */
+    auto _M_final_headers(const node_pointer* _n, header_pointer* _h, size_t _g) const -> void;
     /**
      * @brief remove empty headers from bottom to top, remain the final header
      */
-    auto _M_remove_empty_headers_from_bottom_to_top(header_type* _h) const -> void;
-    auto _M_deallocate_header_recursively(header_type* const _h) const -> void;
+    auto _M_remove_empty_headers_from_bottom_to_top(header_pointer _h) const -> void;
+    auto _M_deallocate_header_recursively(header_pointer const _h) const -> void;
+    auto _M_members(header_pointer const _root) const -> member_range {
+        return {member_iterator{this, _root, this->_M_first_node(_root)}, member_iterator{this, _root, {}}, this->_M_size(_root)};
+    }
+    auto _M_member(node_pointer const _n) const -> typename member_traits<key_type, _Value>::reference {
+        if constexpr (std::is_void_v<_Value>) return _nodes.key(this->_M_node(_n).key());
+        else return {_nodes.key(this->_M_node(_n).key()), this->_M_node(_n).value()};
+    }
+protected:
+    /**
+     * @brief a modification in the undo log, with what its inverse needs
+     * @details `added`: @c _n appended to the final header @c _root, allocated by the change if @c _fresh;
+     * `moved`: @c _n taken from after @c _left under @c _h of the final header @c _root, to a new final header if @c _fresh;
+     * `erased`: @c _n taken as by `moved`, and kept out of the dictionary;
+     * `united`: @c _h appended to @c _root;
+     * `dropped_header`: the empty @c _h unhooked from after @c _sibling under @c _root, and kept;
+     * `dropped_root`: the empty final header @c _h unlinked, and kept
+     */
+    struct journal_entry {
+        enum kind : uint8_t { added, moved, erased, united, dropped_header, dropped_root };
+        kind _kind;
+        bool _fresh = false;
+        node_pointer _n {};
+        node_pointer _left {};
+        header_pointer _h {};
+        header_pointer _root {};
+        header_pointer _sibling {};
+    };
+    /**
+     * @brief the undo log, the keys of `added` and `erased` entries are stacked apart
+     */
+    struct journal {
+        std::vector<journal_entry> _entries;
+        std::vector<key_type> _keys;
+        /// the rollbacks that undid anything, as (generation after it, log size left), the sizes increasing
+        std::vector<std::pair<size_t, size_t>> _cuts;
+        size_t _epoch = 0;
+        size_t _generation = 0;
+        bool _active = false;
+    };
+    struct no_journal {};
+    struct feed {
+        feed() : _ring(std::make_unique<spsc_ring<change_type>>(feed_policy::capacity)) {}
+        feed(feed&& _rhs) noexcept : _ring(std::move(_rhs._ring)), _dropped(std::exchange(_rhs._dropped, false)) {}
+        /// null once taken over by a move
+        std::unique_ptr<spsc_ring<change_type>> _ring;
+        /// whether the newest event pushed is a `reset` standing for the changes dropped on a full ring
+        bool _dropped = false;
+    };
+    struct no_feed_state {};
+    /**
+     * @brief report a change, nothing at all without `feeding`
+     */
+    auto _M_emit(typename change_type::kind_type _kind, class_id _from, class_id _to, const key_type* _k = nullptr) -> void {
+        if constexpr (feeding) {
+            if (!_feed._ring) return;
+            spsc_ring<change_type>& _ring = *_feed._ring;
+            const size_t _room = _ring.room();
+            // the `reset` not taken yet stands for this change too
+            if (_feed._dropped && _room != feed_policy::capacity) return;
+            _feed._dropped = _room == 1;
+            if (_feed._dropped) _ring.push({change_type::reset});
+            else _ring.push(_k ? change_type{_kind, _from, _to, *_k} : change_type{_kind, _from, _to});
+        }
+    }
+    auto _M_logging() const -> bool {
+        if constexpr (reversible) return _journal._active;
+        else return false;
+    }
+    auto _M_log(const journal_entry& _e) const -> void {
+        if constexpr (reversible) _journal._entries.push_back(_e);
+    }
+    /**
+     * @brief log and report the node @c _n of key @c _k appended to the final header @c _root by an insertion
+     */
+    auto _M_log_added(const key_type& _k, node_pointer const _n, header_pointer const _root, bool _fresh) -> void {
+        _M_emit(change_type::moved, {}, _root, &_k);
+        if (!_M_logging()) return;
+        _M_log({journal_entry::added, _fresh, _n, {}, {}, _root, {}});
+        if constexpr (reversible) _journal._keys.push_back(_k);
+    }
+    auto _M_undo(const journal_entry& _e) -> void;
+    /**
+     * @brief fill the empty container from a file written by `save`
+     * @details every classification is materialized as a single final header holding all of its nodes;
+     * throw `std::runtime_error` when the file cannot be read or was not saved from this key and value type
+     */
+    auto _M_load(const std::filesystem::path& _path) -> void;
+    /**
+     * @brief `commit` for any policy, nothing is logged without `reversible`
+     */
+    auto _M_forget() -> void;
 protected:
-    std::unordered_map<key_type, node_type*, _Hash> _nodes;
-    std::unordered_set<header_type*> _final_headers;
+    dictionary_type _nodes;
+    /// any final header, the final headers form a circular list threaded through their sibling links
+    header_pointer _final_headers {};
+    size_t _final_header_count = 0;
+    [[no_unique_address]] mutable std::conditional_t<reversible, journal, no_journal> _journal;
+    [[no_unique_address]] std::conditional_t<feeding, feed, no_feed_state> _feed;
 };
 
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc>
-disjoint_base<_Key, _Value, _Hash, _Alloc>::~disjoint_base() {
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy>
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::~disjoint_base() {
     clear();
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::sibling(const key_type& _k) const -> size_t {
-    if (!contains(_k)) return 0;
-    return _M_final_header(_nodes.at(_k))->size();
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::sibling(const key_type& _k) const -> size_t {
+    node_pointer const _n = _nodes.find(_k);
+    if (!_n) return 0;
+    return this->_M_size(_M_final_header(_n));
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::sibling(const key_type& _x, const key_type& _y) const -> bool {
-    if (!contains(_x) || !contains(_y)) return false;
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::find(const key_type& _k) const -> class_id {
+    node_pointer const _n = _nodes.find(_k);
+    if (!_n) return class_id{};
+    return _M_final_header(_n);
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::sibling(const key_type& _x, const key_type& _y) const -> bool {
+    node_pointer const _nx = _nodes.find(_x);
+    if (!_nx) return false;
     if (_x == _y) return true;
-    return _M_final_header(_nodes.at(_x)) == _M_final_header(_nodes.at(_y));
-}
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::del(const key_type& _k) -> bool {
-    if (!contains(_k)) return false;
-    node_type* const _n = _nodes.at(_k);
-    header_type* const _root = _M_final_header_const(_n);
-    header_type* const _h = _n->unhook();
+    node_pointer const _ny = _nodes.find(_y);
+    if (!_ny) return false;
+    return _M_final_header(_nx) == _M_final_header(_ny);
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> template <std::ranges::forward_range _Keys, std::output_iterator<typename disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::class_id> _Out> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::find_batch(const _Keys& _keys, _Out _out) const -> _Out {
+    std::array<node_pointer, batch_group> _n;
+    std::array<header_pointer, batch_group> _h;
+    for (auto _i = std::ranges::begin(_keys); _i != std::ranges::end(_keys);) {
+        auto _j = _i;
+        for (size_t _g = 0; _j != std::ranges::end(_keys) && _g != batch_group; ++_j, ++_g) _nodes.prefetch(*_j);
+        size_t _g = 0;
+        for (; _i != _j; ++_i, ++_g) {
+            _n[_g] = _nodes.find(*_i);
+            if (_n[_g]) this->_M_prefetch(_n[_g]);
+        }
+        _M_final_headers(_n.data(), _h.data(), _g);
+        for (size_t _k = 0; _k != _g; ++_k) *_out++ = _h[_k];
+    }
+    return _out;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> template <std::ranges::forward_range _Pairs, std::output_iterator<bool> _Out> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::sibling_batch(const _Pairs& _pairs, _Out _out) const -> _Out {
+    static_assert(batch_group % 2 == 0);
+    std::array<node_pointer, batch_group> _n;
+    std::array<header_pointer, batch_group> _h;
+    for (auto _i = std::ranges::begin(_pairs); _i != std::ranges::end(_pairs);) {
+        auto _j = _i;
+        for (size_t _g = 0; _j != std::ranges::end(_pairs) && _g != batch_group; ++_j, _g += 2) {
+            _nodes.prefetch(std::get<0>(*_j));
+            _nodes.prefetch(std::get<1>(*_j));
+        }
+        size_t _g = 0;
+        for (; _i != _j; ++_i, _g += 2) {
+            const auto& _p = *_i;
+            _n[_g] = _nodes.find(std::get<0>(_p));
+            _n[_g + 1] = _nodes.find(std::get<1>(_p));
+            if (_n[_g]) this->_M_prefetch(_n[_g]);
+            if (_n[_g + 1]) this->_M_prefetch(_n[_g + 1]);
+        }
+        _M_final_headers(_n.data(), _h.data(), _g);
+        for (size_t _k = 0; _k != _g; _k += 2) *_out++ = (_h[_k] && _h[_k] == _h[_k + 1]);
+    }
+    return _out;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::del(const key_type& _k) -> bool {
+    node_pointer const _n = _nodes.find(_k);
+    if (!_n) return false;
+    header_pointer const _root = _M_final_header_const(_n);
+    node_pointer const _left = this->_M_left(_n);
+    header_pointer const _h = this->_M_unhook(_n, _root);
     _M_remove_empty_headers_from_bottom_to_top(_h);
-    this->_M_deallocate_node(_n);
+    if (_M_logging()) {
+        // the node is kept for `rollback`, its key is stacked as the dictionary forgets it
+        _M_log({journal_entry::erased, false, _n, _left, _h, _root, {}});
+        if constexpr (reversible) _journal._keys.push_back(_k);
+    }
+    else this->_M_deallocate_node(_n);
+    _M_emit(change_type::moved, _root, {}, &_k);
     _nodes.erase(_k);
     _M_update_final_headers(_root);
     return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::del_all(const key_type& _k) -> bool {
-    if (!contains(_k)) return false;
-    node_type* const _n = _nodes.at(_k);
-    header_type* const _root = _M_final_header_const(_n);
-    // erase all nodes and the header
-    for (auto _i = _nodes.cbegin(); _i != _nodes.cend();) {
-        node_type* const _node = _i->second;
-        if (_M_final_header_const(_node) == _root) {
-            _i = _nodes.erase(_i);
-            this->_M_deallocate_node(_node);
-            continue;
-        }
-        ++_i;
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::del_all(const key_type& _k) -> bool {
+    node_pointer const _n = _nodes.find(_k);
+    if (!_n) return false;
+    _M_forget();
+    header_pointer const _root = _M_final_header_const(_n);
+    _M_emit(change_type::deleted_class, _root, {});
+    _M_unlink_final_header(_root);
+    if constexpr (key_policy::keyed) {
+        _M_erase_tree(_root);
+        return true;
     }
+    // erase all nodes and the header
+    _nodes.erase_if([this, _root](const key_type&, node_pointer const _node) {
+        if (_M_final_header_const(_node) != _root) return false;
+        this->_M_deallocate_node(_node);
+        return true;
+    });
     // all elements have been removed, and the information in `_root` is still retained, so remove it directly
-    _final_headers.erase(_root);
     _M_deallocate_header_recursively(_root);
     return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::del_except(const key_type& _k) -> bool {
-    if (!contains(_k)) return false;
-    node_type* const _n = _nodes.at(_k);
-    header_type* const _root = _M_final_header_const(_n);
-    _n->unhook();
-    // erase all nodes and the header
-    for (auto _i = _nodes.cbegin(); _i != _nodes.cend();) {
-        const key_type& _key = _i->first;
-        node_type* const _node = _i->second;
-        if (_key != _k && _M_final_header_const(_node) == _root) {
-            assert(_n != _node);
-            _i = _nodes.erase(_i);
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::del_except(const key_type& _k) -> bool {
+    node_pointer const _n = _nodes.find(_k);
+    if (!_n) return false;
+    _M_forget();
+    header_pointer const _root = _M_final_header_const(_n);
+    _M_emit(change_type::deleted_class, _root, {});
+    this->_M_unhook(_n, _root);
+    _M_unlink_final_header(_root);
+    if constexpr (key_policy::keyed) {
+        _M_erase_tree(_root);
+    }
+    else {
+        // erase all nodes and the header
+        _nodes.erase_if([this, _root, &_k](const key_type& _key, node_pointer const _node) {
+            if (_key == _k || _M_final_header_const(_node) != _root) return false;
             this->_M_deallocate_node(_node);
-            continue;
-        }
-        ++_i;
+            return true;
+        });
+        // all elements have been removed, and the information in `_root` is still retained, so remove it directly
+        _M_deallocate_header_recursively(_root);
     }
-    // all elements have been removed, and the information in `_root` is still retained, so remove it directly
-    _final_headers.erase(_root);
-    _M_deallocate_header_recursively(_root);
-    header_type* const _new_root = this->_M_allocate_header();
-    _new_root->append_node(_n);
+    header_pointer const _new_root = this->_M_allocate_header();
+    this->_M_append_node(_new_root, _n);
+    _M_update_final_headers(_new_root);
+    _M_emit(change_type::moved, {}, _new_root, &_k);
+    return true;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::join(const key_type& _k) -> bool {
+    node_pointer const _n = _nodes.find(_k);
+    if (!_n) return false;
+    header_pointer const _root = _M_final_header_const(_n);
+    // already alone, nothing changes
+    if (this->_M_size(_root) == 1) return true;
+    node_pointer const _left = this->_M_left(_n);
+    header_pointer const _h = this->_M_unhook(_n, _root);
+    _M_remove_empty_headers_from_bottom_to_top(_h);
+    _M_update_final_headers(_root);
+    header_pointer const _new_root = this->_M_allocate_header();
+    this->_M_append_node(_new_root, _n);
     _M_update_final_headers(_new_root);
+    _M_emit(change_type::moved, _root, _new_root, &_k);
+    if (_M_logging()) _M_log({journal_entry::moved, true, _n, _left, _h, _root, {}});
     return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::join(const key_type& _k) -> bool {
-    if (!contains(_k)) return false;
-    node_type* const _n = _nodes.at(_k);
-    header_type* const _root = _M_final_header_const(_n);
-    header_type* const _h = _n->unhook();
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::join(const key_type& _k, const key_type& _target) -> bool {
+    node_pointer const _n = _nodes.find(_k);
+    node_pointer const _t = _nodes.find(_target);
+    if (!_n || !_t) return false;
+    header_pointer const _root = _M_final_header(_n);
+    header_pointer const _new_root = _M_final_header(_t);
+    if (_root == _new_root) {
+        return true;
+    }
+    node_pointer const _left = this->_M_left(_n);
+    header_pointer const _h = this->_M_unhook(_n, _root);
     _M_remove_empty_headers_from_bottom_to_top(_h);
     _M_update_final_headers(_root);
-    header_type* const _new_root = this->_M_allocate_header();
-    _new_root->append_node(_n);
+    this->_M_append_node(_new_root, _n);
     _M_update_final_headers(_new_root);
+    _M_emit(change_type::moved, _root, _new_root, &_k);
+    if (_M_logging()) _M_log({journal_entry::moved, false, _n, _left, _h, _root, {}});
+    return true;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::merge(const key_type& _x, const key_type& _y) -> bool {
+    node_pointer const _nx = _nodes.find(_x);
+    node_pointer const _ny = _nodes.find(_y);
+    if (!_nx || !_ny) return false;
+    unite(_M_final_header(_nx), _M_final_header(_ny));
+    return true;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::unite(class_id _x, class_id _y) -> class_id {
+    assert(!this->_M_parent(_x) && !this->_M_parent(_y));
+    if (_x == _y) return _x;
+    if (!merge_policy::absorb(this->_M_size(_x), this->_M_size(_y))) std::swap(_x, _y);
+    _M_unlink_final_header(_y);
+    this->_M_append_header(_x, _y);
+    _M_emit(change_type::merged, _y, _x);
+    if (_M_logging()) _M_log({journal_entry::united, false, {}, {}, _y, _x, {}});
+    return _x;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> template <std::ranges::forward_range _Pairs> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::merge_batch(const _Pairs& _pairs) -> size_t {
+    size_t _absorbed = 0;
+    std::array<node_pointer, batch_group> _n;
+    std::array<header_pointer, batch_group> _h;
+    // scratch union-find over the slots of a group, a slot stands for the first slot with the same root
+    std::array<size_t, batch_group> _parent;
+    std::array<size_t, batch_group> _size;
+    std::array<bool, batch_group> _distinct;
+    auto _find = [&](size_t _k) -> size_t {
+        for (; _parent[_k] != _k; _k = _parent[_k]) _parent[_k] = _parent[_parent[_k]];
+        return _k;
+    };
+    for (auto _i = std::ranges::begin(_pairs); _i != std::ranges::end(_pairs);) {
+        auto _j = _i;
+        for (size_t _g = 0; _j != std::ranges::end(_pairs) && _g != batch_group; ++_j, _g += 2) {
+            _nodes.prefetch(std::get<0>(*_j));
+            _nodes.prefetch(std::get<1>(*_j));
+        }
+        size_t _g = 0;
+        for (; _i != _j; ++_i, _g += 2) {
+            const auto& _p = *_i;
+            _n[_g] = _nodes.find(std::get<0>(_p));
+            _n[_g + 1] = _nodes.find(std::get<1>(_p));
+            if (!_n[_g] || !_n[_g + 1]) _n[_g] = _n[_g + 1] = node_pointer{};
+            if (_n[_g]) this->_M_prefetch(_n[_g]);
+            if (_n[_g + 1]) this->_M_prefetch(_n[_g + 1]);
+        }
+        _M_final_headers(_n.data(), _h.data(), _g);
+        for (size_t _k = 0; _k != _g; ++_k) {
+            size_t _first = 0;
+            for (; _h[_first] != _h[_k]; ++_first);
+            _parent[_k] = _first;
+            _distinct[_k] = (_first == _k && _h[_k]);
+            if (_distinct[_k]) _size[_k] = this->_M_size(_h[_k]);
+        }
+        for (size_t _k = 0; _k != _g; _k += 2) {
+            if (!_h[_k]) continue;
+            size_t _x = _find(_k), _y = _find(_k + 1);
+            if (_x == _y) continue;
+            if (!merge_policy::absorb(_size[_x], _size[_y])) std::swap(_x, _y);
+            _parent[_y] = _x;
+            _size[_x] += _size[_y];
+            ++_absorbed;
+        }
+        // the roots of the scratch sets are never absorbed, every other distinct root is appended to one directly
+        for (size_t _k = 0; _k != _g; ++_k) {
+            if (!_distinct[_k]) continue;
+            size_t const _r = _find(_k);
+            if (_r == _k) continue;
+            _M_unlink_final_header(_h[_k]);
+            this->_M_append_header(_h[_r], _h[_k]);
+            _M_emit(change_type::merged, _h[_k], _h[_r]);
+            if (_M_logging()) _M_log({journal_entry::united, false, {}, {}, _h[_k], _h[_r], {}});
+        }
+    }
+    return _absorbed;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::compress() -> void {
+    _M_forget();
+    // once every node sits on its root header, all the other headers are empty and have been released
+    for (const auto& [_k, _n] : _nodes) _M_final_header<compress_path>(_n);
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::compress(const key_type& _k) -> bool {
+    node_pointer const _n = _nodes.find(_k);
+    if (!_n) return false;
+    _M_forget();
+    _M_final_header<compress_path>(_n);
     return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::join(const key_type& _k, const key_type& _target) -> bool {
-    if (!contains(_k) || !contains(_target)) return false;
-    if (sibling(_k, _target)) {
-        return true;
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::clear() -> void {
+    _M_forget();
+    _M_emit(change_type::reset, {}, {});
+    if constexpr (base::bulk_release) {
+        // headers are trivially destructible, only the payloads of the nodes need their destructors
+        static_assert(std::is_trivially_destructible_v<header_type>);
+        if constexpr (!std::is_trivially_destructible_v<node_type>) {
+            for (const auto& [_k, _n] : _nodes) {
+                this->_M_destroy_node(_n);
+            }
+        }
+        _nodes.clear();
+        this->_M_release();
+    }
+    else {
+        for (const auto& [_k, _n] : _nodes) {
+            this->_M_deallocate_node(_n);
+        }
+        _nodes.clear();
+        _M_for_each_final_header([this](header_pointer const _h) {
+            _M_deallocate_header_recursively(_h);
+        });
+    }
+    _final_headers = {};
+    _final_header_count = 0;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::reserve(size_t _n_keys, size_t _n_classes_hint) -> void {
+    _nodes.reserve(_n_keys);
+    this->_M_reserve(_n_keys, _n_classes_hint);
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::shrink_to_fit() -> void {
+    _nodes.shrink_to_fit();
+    this->_M_shrink_to_fit();
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::swap(self& _rhs) noexcept -> void {
+    this->_M_swap(_rhs);
+    _nodes.swap(_rhs._nodes);
+    std::swap(_final_headers, _rhs._final_headers);
+    std::swap(_final_header_count, _rhs._final_header_count);
+    std::swap(_journal, _rhs._journal);
+    // the rings stay with the containers, their consumers start over
+    _M_emit(change_type::reset, {}, {});
+    _rhs._M_emit(change_type::reset, {}, {});
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::save(const std::filesystem::path& _path) const -> void {
+    const size_t _n = _nodes.size();
+    if (_n >= std::numeric_limits<archive_index>::max()) throw std::length_error("too many keys to save");
+    std::ofstream _out(_path, std::ios::binary | std::ios::trunc);
+    if (!_out) throw std::runtime_error("cannot open " + _path.string());
+    // number the classifications in the order of the list of final headers
+    std::unordered_map<header_pointer, archive_index> _number;
+    std::vector<archive_index> _sizes;
+    _number.reserve(_final_header_count);
+    _sizes.reserve(_final_header_count);
+    _M_for_each_final_header([&](header_pointer const _h) {
+        _number.emplace(_h, _sizes.size());
+        _sizes.push_back(this->_M_size(_h));
+    });
+    std::vector<archive_index> _classes;
+    _classes.reserve(_n);
+    for (const auto& [_k, _m] : _nodes) _classes.push_back(_number.find(_M_final_header(_m))->second);
+    std::vector<archive_index> _slots;
+    if constexpr (archive_size<key_type> != 0) {
+        _slots.assign(archive_capacity(_n), 0);
+        uint64_t _i = 0;
+        for (const auto& [_k, _m] : _nodes) archive_slot<_Hash>(_slots, _k, _i++);
+    }
+    archive_header _head {{}, archive_size<key_type>, 0, 0, _n, _sizes.size(), _slots.size()};
+    std::memcpy(_head._signature, archive_header::signature, sizeof(_head._signature));
+    if constexpr (!std::is_void_v<_Value>) {
+        _head._value_size = archive_size<_Value>;
+        _head._values = 1;
+    }
+    _out.write(reinterpret_cast<const char*>(&_head), sizeof(_head));
+    _out.write(reinterpret_cast<const char*>(_classes.data()), _classes.size() * sizeof(archive_index));
+    archive_pad(_out);
+    _out.write(reinterpret_cast<const char*>(_sizes.data()), _sizes.size() * sizeof(archive_index));
+    archive_pad(_out);
+    if constexpr (archive_size<key_type> != 0) {
+        // trivially copyable keys are gathered and written at once
+        std::vector<key_type> _keys;
+        _keys.reserve(_n);
+        for (const auto& [_k, _m] : _nodes) _keys.push_back(_k);
+        _out.write(reinterpret_cast<const char*>(_keys.data()), _n * sizeof(key_type));
+    }
+    else {
+        for (const auto& [_k, _m] : _nodes) serializer<key_type>::write(_out, _k);
+    }
+    archive_pad(_out);
+    _out.write(reinterpret_cast<const char*>(_slots.data()), _slots.size() * sizeof(archive_index));
+    archive_pad(_out);
+    if constexpr (!std::is_void_v<_Value>) {
+        for (const auto& [_k, _m] : _nodes) serializer<_Value>::write(_out, this->_M_node(_m).value());
+        archive_pad(_out);
+    }
+    _out.flush();
+    if (!_out) throw std::runtime_error("cannot write " + _path.string());
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_load(const std::filesystem::path& _path) -> void {
+    std::ifstream _in(_path, std::ios::binary);
+    if (!_in) throw std::runtime_error("cannot open " + _path.string());
+    archive_header _head;
+    _in.read(reinterpret_cast<char*>(&_head), sizeof(_head));
+    const bool _values = !std::is_void_v<_Value>;
+    if (!_in || std::memcmp(_head._signature, archive_header::signature, sizeof(_head._signature)) != 0
+        || _head._key_size != archive_size<key_type> || _head._values != _values) {
+        throw std::runtime_error(_path.string() + " is not a saved container of this type");
+    }
+    if constexpr (!std::is_void_v<_Value>) {
+        if (_head._value_size != archive_size<_Value>) throw std::runtime_error(_path.string() + " is not a saved container of this type");
+    }
+    // every count is checked against the length of the file before anything is sized by it
+    std::error_code _ec;
+    const uint64_t _length = std::filesystem::file_size(_path, _ec);
+    if (_ec) throw std::runtime_error("cannot open " + _path.string());
+    if (_head._size >= std::numeric_limits<archive_index>::max() || _head._classes > _head._size
+        || _head._slots != (archive_size<key_type> != 0 ? archive_capacity(_head._size) : 0)) {
+        throw std::runtime_error("corrupted " + _path.string());
+    }
+    const uint64_t _fixed = sizeof(archive_header) + archive_align(_head._size * sizeof(archive_index))
+        + archive_align(_head._classes * sizeof(archive_index)) + archive_align(_head._size * archive_size<key_type>)
+        + archive_align(_head._slots * sizeof(archive_index)) + _head._size * _head._value_size;
+    if (_fixed > _length) throw std::runtime_error("truncated " + _path.string());
+    std::vector<archive_index> _classes(_head._size);
+    _in.read(reinterpret_cast<char*>(_classes.data()), _classes.size() * sizeof(archive_index));
+    archive_skip_pad(_in);
+    _in.seekg(_head._classes * sizeof(archive_index), std::ios::cur);
+    archive_skip_pad(_in);
+    std::vector<key_type> _keys;
+    if constexpr (archive_size<key_type> != 0) {
+        _keys.resize(_head._size);
+        _in.read(reinterpret_cast<char*>(_keys.data()), _head._size * sizeof(key_type));
+    }
+    else {
+        _keys.reserve(_head._size);
+        for (uint64_t _i = 0; _i != _head._size && _in; ++_i) _keys.push_back(serializer<key_type>::read(_in));
+    }
+    archive_skip_pad(_in);
+    _in.seekg(_head._slots * sizeof(archive_index), std::ios::cur);
+    archive_skip_pad(_in);
+    if (!_in) throw std::runtime_error("truncated " + _path.string());
+    this->reserve(_head._size, _head._classes);
+    // the roots are listed at once, so that `clear` releases them if a node fails
+    std::vector<header_pointer> _roots(_head._classes);
+    for (auto& _root : _roots) {
+        _root = this->_M_allocate_header();
+        _M_link_final_header(_root);
+    }
+    for (uint64_t _i = 0; _i != _head._size; ++_i) {
+        // a key met twice would be counted in its classification, but could not be found or released
+        if (_classes[_i] >= _roots.size() || _nodes.find(_keys[_i])) throw std::runtime_error("corrupted " + _path.string());
+        node_pointer _n;
+        if constexpr (std::is_void_v<_Value>) _n = this->_M_allocate_node();
+        else _n = this->_M_allocate_node(serializer<_Value>::read(_in));
+        _M_insert_node(_keys[_i], _n);
+        this->_M_append_node(_roots[_classes[_i]], _n);
+    }
+    if (!_in) throw std::runtime_error("truncated " + _path.string());
+    for (header_pointer const _root : _roots) _M_update_final_headers(_root);
+    _M_emit(change_type::reset, {}, {});
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::checkpoint() -> checkpoint_type requires reversible {
+    _journal._active = true;
+    return {_journal._epoch, _journal._generation, _journal._entries.size()};
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::rollback(const checkpoint_type& _c) -> void requires reversible {
+    // the smallest log left by a rollback after the checkpoint is the first cut of a later generation
+    const auto _cut = std::ranges::upper_bound(_journal._cuts, _c._generation, {}, &std::pair<size_t, size_t>::first);
+    if (_c._epoch != _journal._epoch || _c._size > _journal._entries.size() || (_cut != _journal._cuts.end() && _cut->second < _c._size)) {
+        throw std::logic_error("rollback to a discarded checkpoint");
+    }
+    if (_journal._entries.size() == _c._size) return;
+    for (; _journal._entries.size() != _c._size; _journal._entries.pop_back()) _M_undo(_journal._entries.back());
+    ++_journal._generation;
+    while (!_journal._cuts.empty() && _journal._cuts.back().second >= _c._size) _journal._cuts.pop_back();
+    _journal._cuts.emplace_back(_journal._generation, _c._size);
+    _M_emit(change_type::reset, {}, {});
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_undo(const journal_entry& _e) -> void {
+    if constexpr (reversible) {
+        switch (_e._kind) {
+        case journal_entry::added:
+            this->_M_unhook(_e._n, _e._root);
+            _nodes.erase(_journal._keys.back());
+            _journal._keys.pop_back();
+            this->_M_deallocate_node(_e._n);
+            if (_e._fresh) {
+                _M_unlink_final_header(_e._root);
+                this->_M_deallocate_header(_e._root);
+            }
+            break;
+        case journal_entry::moved: {
+            // the later changes are undone, so the node still sits on the final header it was appended to
+            header_pointer const _current = this->_M_parent(_e._n);
+            this->_M_unhook(_e._n, _current);
+            if (_e._fresh) {
+                _M_unlink_final_header(_current);
+                this->_M_deallocate_header(_current);
+            }
+            this->_M_insert_node_after(_e._h, _e._left, _e._n, _e._root);
+            break;
+        }
+        case journal_entry::erased:
+            // the entry owns the node until the insertion succeeds, `_M_insert_node` would free it on a throw
+            if constexpr (key_policy::keyed) this->_M_node(_e._n).set_key(_nodes.insert(_journal._keys.back(), _e._n));
+            else _nodes.insert(_journal._keys.back(), _e._n);
+            _journal._keys.pop_back();
+            this->_M_insert_node_after(_e._h, _e._left, _e._n, _e._root);
+            break;
+        case journal_entry::united:
+            this->_M_detach_header(_e._root, _e._h);
+            _M_link_final_header(_e._h);
+            break;
+        case journal_entry::dropped_header:
+            this->_M_insert_header_after(_e._root, _e._sibling, _e._h);
+            break;
+        case journal_entry::dropped_root:
+            _M_link_final_header(_e._h);
+            break;
+        }
+    }
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_forget() -> void {
+    if constexpr (reversible) {
+        for (const journal_entry& _e : _journal._entries) {
+            if (_e._kind == journal_entry::erased) this->_M_deallocate_node(_e._n);
+            else if (_e._kind == journal_entry::dropped_header || _e._kind == journal_entry::dropped_root) this->_M_deallocate_header(_e._h);
+        }
+        _journal._entries.clear();
+        _journal._keys.clear();
+        _journal._cuts.clear();
+        _journal._active = false;
+        ++_journal._epoch;
     }
-    node_type* const _n = _nodes.at(_k);
-    header_type* const _root = _M_final_header_const(_n);
-    header_type* const _h = _n->unhook();
-    _M_remove_empty_headers_from_bottom_to_top(_h);
-    _M_update_final_headers(_root);
-    header_type* const _new_root = _M_final_header(_nodes.at(_target));
-    _new_root->append_node(_n);
-    _M_update_final_headers(_new_root);
-    return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::merge(const key_type& _x, const key_type& _y) -> bool {
-    if (!contains(_x) || !contains(_y)) return false;
-    if (sibling(_x, _y)) return true;
-    header_type* const _xr = _M_final_header(_nodes.at(_x));
-    header_type* const _yr = _M_final_header(_nodes.at(_y));
-    _xr->append_header(_yr);
-    _M_update_final_headers(_xr);
-    _M_update_final_headers(_yr);
-    return true;
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::members(const key_type& _k) const -> member_range requires key_policy::keyed {
+    node_pointer const _n = _nodes.find(_k);
+    if (!_n) return {member_iterator{}, member_iterator{}, 0};
+    return _M_members(_M_final_header(_n));
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::clear() -> void {
-    for (const auto& [_k, _n] : _nodes) {
+
+
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_allocate_alone_header(node_pointer const _n) -> header_pointer {
+    try {
+        return this->_M_allocate_header();
+    }
+    catch (...) {
         this->_M_deallocate_node(_n);
+        throw;
+    }
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_insert_node(const key_type& _k, node_pointer const _n, header_pointer const _alone) -> void {
+    try {
+        if constexpr (key_policy::keyed) this->_M_node(_n).set_key(_nodes.insert(_k, _n));
+        else _nodes.insert(_k, _n);
     }
-    _nodes.clear();
-    for (header_type* _h : _final_headers) {
-        _M_deallocate_header_recursively(_h);
+    catch (...) {
+        this->_M_deallocate_node(_n);
+        if (_alone) this->_M_deallocate_header(_alone);
+        throw;
     }
-    _final_headers.clear();
 }
-
-
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::_M_update_final_headers(header_type* const _h) -> void {
-    if (_h->get() == nullptr) {
-        if (_h->size() == 0) {
-            assert(_final_headers.contains(_h));
-            _final_headers.erase(_h);
-            this->_M_deallocate_header(_h);
-        }
-        else if (!_final_headers.contains(_h)) {
-            _final_headers.insert(_h);
-        }
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_erase_tree(header_pointer const _h) -> void {
+    static_assert(key_policy::keyed);
+    this->_M_forward_nodes(_h, [this](node_pointer const _n) {
+        _nodes.erase(_nodes.key(this->_M_node(_n).key()));
+        this->_M_deallocate_node(_n);
+    });
+    this->_M_forward_headers(_h, [this](header_pointer const _i) {
+        _M_erase_tree(_i);
+    });
+    this->_M_deallocate_header(_h);
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_update_final_headers(header_pointer const _h) -> void {
+    assert(!this->_M_parent(_h));
+    if (this->_M_size(_h) == 0) {
+        _M_emit(change_type::deleted_class, _h, {});
+        _M_unlink_final_header(_h);
+        if (_M_logging()) _M_log({journal_entry::dropped_root, false, {}, {}, _h, {}, {}});
+        else this->_M_deallocate_header(_h);
+    }
+    else if (!this->_M_linked_root(_h)) {
+        _M_link_final_header(_h);
     }
-    else { // not a final header, remove it
-        _final_headers.erase(_h);
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_link_final_header(header_pointer const _h) -> void {
+    this->_M_link_root(_final_headers, _h);
+    ++_final_header_count;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_unlink_final_header(header_pointer const _h) -> void {
+    this->_M_unlink_root(_final_headers, _h);
+    --_final_header_count;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> template <typename _Handler> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_for_each_final_header(const _Handler& _hdr) const -> void {
+    header_pointer _h = _final_headers;
+    for (size_t _i = 0; _i != _final_header_count; ++_i) {
+        header_pointer const _next = this->_M_next_root(_h);
+        _hdr(_h);
+        _h = _next;
     }
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::_M_final_header(node_type* const _n) const -> header_type* {
-    header_type* _fh = _n->get();
-    for (; _fh->get() != nullptr; _fh = _fh->get());
-    if (_fh != _n->get()) {
-        header_type* _h = _n->unhook();
-        _fh->append_node(_n);
-        _M_remove_empty_headers_from_bottom_to_top(_h);
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> template <typename _Compress> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_final_header(node_pointer const _n) const -> header_pointer {
+    header_pointer _fh = this->_M_parent(_n);
+    if constexpr (_Compress::path) {
+        for (; this->_M_parent(_fh) && this->_M_parent(this->_M_parent(_fh)); _fh = this->_M_parent(_fh)) {
+            header_pointer const _p = this->_M_hoist(_fh);
+            _M_remove_empty_headers_from_bottom_to_top(_p);
+        }
+    }
+    for (; this->_M_parent(_fh); _fh = this->_M_parent(_fh));
+    if constexpr (_Compress::node) {
+        if (_fh != this->_M_parent(_n)) {
+            header_pointer _h = this->_M_unhook(_n, _fh);
+            this->_M_append_node(_fh, _n);
+            _M_remove_empty_headers_from_bottom_to_top(_h);
+        }
     }
     return _fh;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::_M_final_header_const(node_type* const _n) const -> header_type* {
-    header_type* _fh = _n->get();
-    for (; _fh->get() != nullptr; _fh = _fh->get());
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_final_header_const(node_pointer const _n) const -> header_pointer {
+    header_pointer _fh = this->_M_parent(_n);
+    for (; this->_M_parent(_fh); _fh = this->_M_parent(_fh));
     return _fh;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::_M_remove_empty_headers_from_bottom_to_top(header_type* _h) const -> void {
-    while (_h->get() != nullptr && _h->size() == 0) {
-        header_type* _next = _h->unhook();
-        this->_M_deallocate_header(_h);
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_final_headers(const node_pointer* _n, header_pointer* _h, size_t _g) const -> void {
+    for (size_t _k = 0; _k != _g; ++_k) {
+        _h[_k] = _n[_k] ? this->_M_parent(_n[_k]) : header_pointer{};
+        if (_h[_k]) this->_M_prefetch(_h[_k]);
+    }
+    // climb one level of every path per round
+    for (bool _climbing = true; _climbing;) {
+        _climbing = false;
+        for (size_t _k = 0; _k != _g; ++_k) {
+            if (!_h[_k]) continue;
+            header_pointer const _p = this->_M_parent(_h[_k]);
+            if (!_p) continue;
+            _h[_k] = _p;
+            this->_M_prefetch(_p);
+            _climbing = true;
+        }
+    }
+    // the paths are in the cache now, compress them as a single lookup would, the final headers do not change
+    if constexpr (compress_policy::node || compress_policy::path) {
+        for (size_t _k = 0; _k != _g; ++_k) {
+            if (_n[_k] && this->_M_parent(_n[_k]) != _h[_k]) _M_final_header(_n[_k]);
+        }
+    }
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_remove_empty_headers_from_bottom_to_top(header_pointer _h) const -> void {
+    while (this->_M_parent(_h) && this->_M_empty(_h)) {
+        header_pointer const _sibling = this->_M_left(_h);
+        header_pointer _next = this->_M_unhook(_h);
+        if (_M_logging()) _M_log({journal_entry::dropped_header, false, {}, {}, _h, _next, _sibling});
+        else this->_M_deallocate_header(_h);
         _h = _next;
     }
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::_M_deallocate_header_recursively(header_type* const _h) const -> void {
-    _h->forward_headers([this](header_type* _i) {
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::_M_deallocate_header_recursively(header_pointer const _h) const -> void {
+    this->_M_forward_headers(_h, [this](header_pointer _i) {
         this->_M_deallocate_header_recursively(_i);
     });
     this->_M_deallocate_header(_h);
@@ -548,48 +2825,80 @@ namespace {
 static constexpr inline const char* fatal_empty_header = "\\exists(_final_headers)?.empty()";
 static constexpr inline const char* fatal_empty_node = "\\exists(_nodes) == nullptr";
 static constexpr inline const char* fatal_node_in_header = "\\exists(_nodes) not in \\any(_final_headers)";
+static constexpr inline const char* fatal_node_count = "\\exists(_final_headers).size() != \\sum(list<node>)";
 static constexpr inline const char* fatal_nodes_count = "_nodes.size() != \\sum(\\all(_final_headers).size())";
+static constexpr inline const char* fatal_final_headers = "_final_headers is not a cycle of classification() final headers";
+static constexpr inline const char* fatal_node_key = "\\exists(_nodes).key() != its key";
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_base<_Key, _Value, _Hash, _Alloc>::check() const -> void {
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::check() const -> void {
     size_t _count_from_headers = 0ul;
-    for (auto* _i : _final_headers) {
-        if (_i == nullptr || _i->size() == 0) throw std::logic_error(fatal_empty_header);
-        _i->check();
-        _count_from_headers += _i->size();
-    }
+    header_pointer _last {};
+    _M_for_each_final_header([&](header_pointer const _i) {
+        if (!_i || this->_M_size(_i) == 0) throw std::logic_error(fatal_empty_header);
+        if (this->_M_parent(_i) || !this->_M_linked_root(_i)) throw std::logic_error(fatal_final_headers);
+        if (this->_M_check(_i) != this->_M_size(_i)) throw std::logic_error(fatal_node_count);
+        _count_from_headers += this->_M_size(_i);
+        _last = _i;
+    });
+    if (_last && this->_M_next_root(_last) != _final_headers) throw std::logic_error(fatal_final_headers);
     if (_count_from_headers != _nodes.size()) throw std::logic_error(fatal_nodes_count);
-    for (auto _i = _nodes.cbegin(); _i != _nodes.cend(); ++_i) {
-        if (_i->second == nullptr) throw std::logic_error(fatal_empty_node);
-        auto* const _h = _M_final_header_const(_i->second);
-        if (!_final_headers.contains(_h)) throw std::logic_error(fatal_node_in_header);
+    for (const auto& [_k, _n] : _nodes) {
+        if (!_n) throw std::logic_error(fatal_empty_node);
+        auto const _h = _M_final_header_const(_n);
+        if (!this->_M_linked_root(_h)) throw std::logic_error(fatal_node_in_header);
+        if constexpr (key_policy::keyed) {
+            if (!(_nodes.key(this->_M_node(_n).key()) == _k)) throw std::logic_error(fatal_node_key);
+        }
     }
     return;
 }
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>::height() const -> size_t {
+    size_t _h = 0ul;
+    _M_for_each_final_header([this, &_h](header_pointer const _i) {
+        const size_t _sub = this->_M_height(_i);
+        if (_sub > _h) _h = _sub;
+    });
+    return _h;
+}
 }
 
-template <typename _Key, typename _Hash = std::hash<_Key>, typename _Alloc = std::allocator<_Key>> struct disjoint_set;
-template <typename _Key, typename _Value, typename _Hash = std::hash<_Key>, typename _Alloc = std::allocator<_Key>> struct disjoint_map;
+template <typename _Key, typename _Hash = std::hash<_Key>, typename _Alloc = std::allocator<_Key>, typename _Policy = disjoint_policy> struct disjoint_set;
+template <typename _Key, typename _Value, typename _Hash = std::hash<_Key>, typename _Alloc = std::allocator<_Key>, typename _Policy = disjoint_policy> struct disjoint_map;
+/**
+ * @brief disjoint set keyed by dense non-negative integers, the node dictionary is a flat array
+ */
+template <typename _Index, typename _Alloc = std::allocator<_Index>> using dense_disjoint_set = disjoint_set<_Index, std::hash<_Index>, _Alloc, dense_policy>;
+/**
+ * @brief disjoint map keyed by dense non-negative integers, the node dictionary is a flat array
+ */
+template <typename _Index, typename _Value, typename _Alloc = std::allocator<_Index>> using dense_disjoint_map = disjoint_map<_Index, _Value, std::hash<_Index>, _Alloc, dense_policy>;
 
 /**
  * @brief disjoint set, a container for managing the set to which elements belongs
  * @tparam _Key type of key object
  * @tparam _Hash hashing function object type, defaults to std::hash<_Key>.
  * @tparam _Alloc allocator type, defaults to std::allocator<_Key>.
+ * @tparam _Policy policy type, defaults to disjoint_policy.
  * @implements implemented by hash table and short tree
 */
-template <typename _Key, typename _Hash, typename _Alloc>
-struct disjoint_set : public disjoint_base<_Key, void, _Hash, _Alloc> {
-    using base = disjoint_base<_Key, void, _Hash, _Alloc>;
-    using self = disjoint_set<_Key, _Hash, _Alloc>;
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy>
+struct disjoint_set : public disjoint_base<_Key, void, _Hash, _Alloc, _Policy> {
+    using base = disjoint_base<_Key, void, _Hash, _Alloc, _Policy>;
+    using self = disjoint_set<_Key, _Hash, _Alloc, _Policy>;
     using node_type = typename base::node_type;
     using header_type = typename base::header_type;
+    using node_pointer = typename base::node_pointer;
+    using header_pointer = typename base::header_pointer;
     using key_type = typename base::key_type;
 public:
     disjoint_set() = default;
     disjoint_set(std::initializer_list<std::initializer_list<key_type>>);
     disjoint_set(const self& _rhs);
+    disjoint_set(self&& _rhs) noexcept : base(std::move(_rhs)) {}
     auto operator=(const self& _rhs) -> self&;
+    auto operator=(self&& _rhs) noexcept -> self&;
     virtual ~disjoint_set() = default;
 public:
     auto operator==(const self& _rhs) const -> bool;
@@ -608,6 +2917,24 @@ public:
      * @return return false when the @c _target is not in disjoint set or the key fails to be added
      */
     auto add(const key_type& _k, const key_type& _target) -> bool;
+    /**
+     * @brief build the partition of the keys into the connected components of the edges
+     * @param _keys the keys, a repeated key is added once
+     * @param _edges pairs of keys read by `std::get<0>` and `std::get<1>`, an edge with an endpoint out of @c _keys is ignored
+     * @param _threads the number of threads uniting the edges of a sized random access range, 0 for all hardware threads
+     * @details the components are found by a concurrent union-find over the indices of the keys,
+     * then each one is materialized as a single final header holding all of its nodes
+     */
+    template <std::ranges::input_range _Keys, std::ranges::input_range _Edges>
+    static auto from_edges(_Keys&& _keys, _Edges&& _edges, unsigned _threads = 1) -> self;
+    /**
+     * @brief read a container written by `save`, each classification as a single final header
+     */
+    static auto load(const std::filesystem::path& _path) -> self {
+        self _s;
+        _s._M_load(_path);
+        return _s;
+    }
 private:
     auto _M_assign(const self& _rhs) -> void;
 };
@@ -617,14 +2944,17 @@ private:
  * @tparam _Value type of value object
  * @tparam _Hash hashing function object type, defaults to std::hash<_Key>.
  * @tparam _Alloc allocator type, defaults to std::allocator<_Key>.
+ * @tparam _Policy policy type, defaults to disjoint_policy.
  * @implements implemented by hash table and short tree
 */
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc>
-struct disjoint_map : public disjoint_base<_Key, _Value, _Hash, _Alloc> {
-    using base = disjoint_base<_Key, _Value, _Hash, _Alloc>;
-    using self = disjoint_map<_Key, _Value, _Hash, _Alloc>;
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy>
+struct disjoint_map : public disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy> {
+    using base = disjoint_base<_Key, _Value, _Hash, _Alloc, _Policy>;
+    using self = disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>;
     using node_type = typename base::node_type;
     using header_type = typename base::header_type;
+    using node_pointer = typename base::node_pointer;
+    using header_pointer = typename base::header_pointer;
     using key_type = typename base::key_type;
     using mapped_type = _Value;
     using value_type = std::pair<const key_type, mapped_type>;
@@ -632,7 +2962,9 @@ public:
     disjoint_map() = default;
     disjoint_map(std::initializer_list<std::initializer_list<value_type>>);
     disjoint_map(const self& _rhs);
+    disjoint_map(self&& _rhs) noexcept : base(std::move(_rhs)) {}
     auto operator=(const self& _rhs) -> self&;
+    auto operator=(self&& _rhs) noexcept -> self&;
     virtual ~disjoint_map() = default;
 public:
     auto operator==(const self& _rhs) const -> bool;
@@ -645,21 +2977,45 @@ public:
      * @param _v key-value pair
      * @return return false when the key is already in disjoint set or the pair fails to be added
      */
-    auto add(const value_type& _v) -> bool;
+    auto add(const value_type& _v) -> bool { return try_emplace(_v.first, _v.second); }
+    auto add(value_type&& _v) -> bool { return try_emplace(_v.first, std::move(_v.second)); }
     /**
      * @brief add key-value pair to the classification, which contains the given key
      * @param _v key-value pair
      * @param _target the given key
      * @return return false when the @c _target is not in disjoint set or the pair fails to be added
      */
-    auto add(const value_type& _v, const key_type& _target) -> bool;
+    auto add(const value_type& _v, const key_type& _target) -> bool { return emplace(_v.first, _target, _v.second); }
+    auto add(value_type&& _v, const key_type& _target) -> bool { return emplace(_v.first, _target, std::move(_v.second)); }
+    /**
+     * @brief add the key to a new classification, the value is constructed in place from @c _args
+     * @param _k the specific key
+     * @return return false when the key is already in disjoint set, nothing is constructed then
+     */
+    template <typename... _Args> auto try_emplace(const key_type& _k, _Args&&... _args) -> bool;
+    /**
+     * @brief add the key to the classification, which contains the given key, the value is constructed in place from @c _args
+     * @param _k the specific key
+     * @param _target the given key
+     * @return return false when the key is already in disjoint set or the @c _target is not, nothing is constructed then
+     */
+    template <typename... _Args> auto emplace(const key_type& _k, const key_type& _target, _Args&&... _args) -> bool;
     /**
      * @brief update the value associated with the specific key
      * @param _k the specific key
      * @param _m the value
      * @return return false when the key is not in disjoint set or the value fails to be updated
      */
+    auto update(const key_type& _k, const mapped_type& _m) -> bool;
     auto update(const key_type& _k, mapped_type&& _m) -> bool;
+    /**
+     * @brief read a container written by `save`, each classification as a single final header, with the values
+     */
+    static auto load(const std::filesystem::path& _path) -> self {
+        self _s;
+        _s._M_load(_path);
+        return _s;
+    }
     
     /**
      * @brief return value according to the given key
@@ -672,8 +3028,8 @@ private:
 
 
 
-template <typename _Key, typename _Hash, typename _Alloc>
-disjoint_set<_Key, _Hash, _Alloc>::disjoint_set(std::initializer_list<std::initializer_list<key_type>> _llk) {
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy>
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::disjoint_set(std::initializer_list<std::initializer_list<key_type>> _llk) {
     for (auto _i = _llk.begin(); _i != _llk.end(); ++_i) {
         if (_i->begin() != _i->end()) {
             add(*(_i->begin()));
@@ -683,83 +3039,135 @@ disjoint_set<_Key, _Hash, _Alloc>::disjoint_set(std::initializer_list<std::initi
         }
     }
 };
-template <typename _Key, typename _Hash, typename _Alloc>
-disjoint_set<_Key, _Hash, _Alloc>::disjoint_set(const self& _rhs) : base(_rhs) {
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy>
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::disjoint_set(const self& _rhs) : base(_rhs) {
     _M_assign(_rhs);
 };
-template <typename _Key, typename _Hash, typename _Alloc> auto
-disjoint_set<_Key, _Hash, _Alloc>::operator=(const self& _rhs) -> self& {
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::operator=(const self& _rhs) -> self& {
+    if (&_rhs == this) return *this;
+    this->clear();
+    // a failed copy would leave the roots it listed empty
+    try { _M_assign(_rhs); }
+    catch (...) { this->clear(); throw; }
+    return *this;
+};
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::operator=(self&& _rhs) noexcept -> self& {
     if (&_rhs == this) return *this;
-    this->clear(); _M_assign(_rhs);
+    this->clear(); this->swap(_rhs);
     return *this;
 };
 /**
- * @implements T <= o(size) * o(classification), S = o(classification)
- * prove that `*this` \subseteq `_rhs` and `|*this|` \eq `|_rhs|`
+ * @implements T = o(size) expected, S = o(classification)
+ * each classification of `*this` is mapped to the classification of `_rhs` holding its first key,
+ * every other key must land in the same one, so `*this` refines `_rhs`, and with as many classifications they are equal
  */
-template <typename _Key, typename _Hash, typename _Alloc> auto
-disjoint_set<_Key, _Hash, _Alloc>::operator==(const self& _rhs) const -> bool {
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::operator==(const self& _rhs) const -> bool {
     if (this->size() != _rhs.size() || this->classification() != _rhs.classification()) {
         return false;
     }
-    std::vector<key_type> _delegate_keys; // for `_rhs`
-    auto index_of_key = [this, &_delegate_keys](const key_type& _k) -> size_t {
-        for (size_t _i = 0; _i != _delegate_keys.size(); ++_i) {
-            if (this->sibling(_k, _delegate_keys[_i])) return _i;
-        }
-        return _delegate_keys.size();
-    };
-    for (const auto& _i : this->_nodes) {
-        const key_type& _k = _i.first;
-        node_type* const _n = _i.second;
-        if (!_rhs.contains(_k)) {
-            return false;
-        }
-        if (_rhs.sibling(_k) != this->sibling(_k)) {
-            return false;
-        }
-        const size_t _index = index_of_key(_k);
-        if (_index == _delegate_keys.size()) {
-            if (this->sibling(_k) != 1) {
-                _delegate_keys.push_back(_k);
-            }
-            continue;
-        }
-        const key_type& _dk = _delegate_keys[_index];
-        if (!_rhs.sibling(_k, _dk)) {
-            return false;
-        }
+    std::unordered_map<header_pointer, header_pointer> _roots;
+    _roots.reserve(this->classification());
+    for (const auto& [_k, _n] : this->_nodes) {
+        node_pointer const _m = _rhs._nodes.find(_k);
+        if (!_m) return false;
+        header_pointer const _root = _rhs._M_final_header(_m);
+        const auto [_i, _inserted] = _roots.try_emplace(this->_M_final_header(_n), _root);
+        if (!_inserted && !(_i->second == _root)) return false;
     }
     return true;
 };
-template <typename _Key, typename _Hash, typename _Alloc> auto
-disjoint_set<_Key, _Hash, _Alloc>::operator!=(const self& _rhs) const -> bool {
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::operator!=(const self& _rhs) const -> bool {
     return !this->operator==(_rhs);
 }
-template <typename _Key, typename _Hash, typename _Alloc> auto
-disjoint_set<_Key, _Hash, _Alloc>::add(const key_type& _k) -> bool {
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::add(const key_type& _k) -> bool {
     if (this->contains(_k)) return false;
-    header_type* const _root = this->_M_allocate_header();
-    node_type* const _n = this->_M_allocate_node();
-    _root->append_node(_n);
-    this->_nodes[_k] = _n;
+    node_pointer const _n = this->_M_allocate_node();
+    header_pointer const _root = this->_M_allocate_alone_header(_n);
+    this->_M_insert_node(_k, _n, _root);
+    this->_M_append_node(_root, _n);
     this->_M_update_final_headers(_root);
+    this->_M_log_added(_k, _n, _root, true);
     return true;
 }
-template <typename _Key, typename _Hash, typename _Alloc> auto
-disjoint_set<_Key, _Hash, _Alloc>::add(const key_type& _k, const key_type& _target) -> bool {
-    if (this->contains(_k) || !this->contains(_target)) return false;
-    header_type* const _root = this->_M_final_header(this->_nodes.at(_target));
-    node_type* const _n = this->_M_allocate_node();
-    _root->append_node(_n);
-    this->_nodes[_k] = _n;
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> template <std::ranges::input_range _Keys, std::ranges::input_range _Edges> auto
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::from_edges(_Keys&& _keys, _Edges&& _edges, unsigned _threads) -> self {
+    // number the distinct keys, an index is stored plus one, so that 0 stays the absent value
+    typename _Policy::dictionary_policy::template type<key_type, size_t, _Hash> _index;
+    std::vector<key_type> _order;
+    if constexpr (std::ranges::sized_range<_Keys>) {
+        _index.reserve(std::ranges::size(_keys));
+        _order.reserve(std::ranges::size(_keys));
+    }
+    for (const auto& _k : _keys) {
+        if (_index.find(_k) != 0) continue;
+        _order.push_back(_k);
+        _index.insert(_k, _order.size());
+    }
+    const size_t _n = _order.size();
+    atomic_forest _components(_n);
+    auto _unite = [&_index, &_components](auto _first, auto _last) {
+        for (; _first != _last; ++_first) {
+            const auto& _e = *_first;
+            const size_t _x = _index.find(std::get<0>(_e)), _y = _index.find(std::get<1>(_e));
+            if (_x != 0 && _y != 0) _components.unite(_x - 1, _y - 1);
+        }
+    };
+    if constexpr (std::ranges::random_access_range<_Edges> && std::ranges::sized_range<_Edges>) {
+        using difference_type = std::ranges::range_difference_t<_Edges>;
+        const size_t _m = std::ranges::size(_edges);
+        const size_t _t = std::max<size_t>(1, std::min<size_t>(_threads == 0 ? std::thread::hardware_concurrency() : _threads, _m));
+        const auto _begin = std::ranges::begin(_edges);
+        auto _slice = [_begin, _m, _t](size_t _i) { return _begin + static_cast<difference_type>(_m * _i / _t); };
+        std::vector<std::jthread> _workers;
+        _workers.reserve(_t - 1);
+        for (size_t _i = 1; _i != _t; ++_i) _workers.emplace_back(_unite, _slice(_i), _slice(_i + 1));
+        _unite(_slice(0), _slice(1));
+    }
+    else {
+        _unite(std::ranges::begin(_edges), std::ranges::end(_edges));
+    }
+    // materialize one final header per component
+    self _s;
+    size_t _classes = 0;
+    for (size_t _i = 0; _i != _n; ++_i) _classes += (_components.find(_i) == _i);
+    _s.reserve(_n, _classes);
+    // the roots are listed at once, so that `_s` releases them if a node fails
+    std::vector<header_pointer> _roots(_n);
+    for (size_t _i = 0; _i != _n; ++_i) {
+        if (_components.find(_i) != _i) continue;
+        _roots[_i] = _s._M_allocate_header();
+        _s._M_link_final_header(_roots[_i]);
+    }
+    for (size_t _i = 0; _i != _n; ++_i) {
+        node_pointer const _node = _s._M_allocate_node();
+        _s._M_insert_node(_order[_i], _node);
+        _s._M_append_node(_roots[_components.find(_i)], _node);
+    }
+    _s._M_emit(base::change_type::reset, {}, {});
+    return _s;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::add(const key_type& _k, const key_type& _target) -> bool {
+    if (this->contains(_k)) return false;
+    node_pointer const _t = this->_nodes.find(_target);
+    if (!_t) return false;
+    node_pointer const _n = this->_M_allocate_node();
+    this->_M_insert_node(_k, _n);
+    header_pointer const _root = this->_M_final_header(_t);
+    this->_M_append_node(_root, _n);
     this->_M_update_final_headers(_root);
+    this->_M_log_added(_k, _n, _root, false);
     return true;
 }
 
 
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc>
-disjoint_map<_Key, _Value, _Hash, _Alloc>::disjoint_map(std::initializer_list<std::initializer_list<value_type>> _llv) {
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy>
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::disjoint_map(std::initializer_list<std::initializer_list<value_type>> _llv) {
     for (auto _i = _llv.begin(); _i != _llv.end(); ++_i) {
         if (_i->begin() != _i->end()) {
             add(*(_i->begin()));
@@ -769,162 +3177,718 @@ disjoint_map<_Key, _Value, _Hash, _Alloc>::disjoint_map(std::initializer_list<st
         }
     }
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc>
-disjoint_map<_Key, _Value, _Hash, _Alloc>::disjoint_map(const self& _rhs) : base(_rhs) {
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy>
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::disjoint_map(const self& _rhs) : base(_rhs) {
     _M_assign(_rhs);
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::operator=(const self& _rhs) -> self& {
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::operator=(const self& _rhs) -> self& {
+    if (&_rhs == this) return *this;
+    this->clear();
+    // a failed copy would leave the roots it listed empty
+    try { _M_assign(_rhs); }
+    catch (...) { this->clear(); throw; }
+    return *this;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::operator=(self&& _rhs) noexcept -> self& {
     if (&_rhs == this) return *this;
-    this->clear(); _M_assign(_rhs);
+    this->clear(); this->swap(_rhs);
     return *this;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::operator==(const self& _rhs) const -> bool {
+/**
+ * @implements T = o(size) expected, S = o(classification), as `disjoint_set::operator==`
+ */
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::operator==(const self& _rhs) const -> bool {
     if (this->size() != _rhs.size() || this->classification() != _rhs.classification()) {
         return false;
     }
-    std::vector<key_type> _delegate_keys; // for `_rhs`
-    auto index_of_key = [this, &_delegate_keys](const key_type& _k) -> size_t {
-        for (size_t _i = 0; _i != _delegate_keys.size(); ++_i) {
-            if (this->sibling(_k, _delegate_keys[_i])) return _i;
-        }
-        return _delegate_keys.size();
-    };
-    for (const auto& _i : this->_nodes) {
-        const key_type& _k = _i.first;
-        node_type* const _n = _i.second;
-        if (!_rhs.contains(_k)) {
-            return false;
-        }
-        if (_rhs.sibling(_k) != this->sibling(_k)) {
-            return false;
-        }
-        if (_rhs.at(_k) != this->at(_k)) {
-            return false;
-        }
-        const size_t _index = index_of_key(_k);
-        if (_index == _delegate_keys.size()) {
-            if (this->sibling(_k) != 1) {
-                _delegate_keys.push_back(_k);
-            }
-            continue;
-        }
-        const key_type& _dk = _delegate_keys[_index];
-        if (!_rhs.sibling(_k, _dk)) {
-            return false;
-        }
+    std::unordered_map<header_pointer, header_pointer> _roots;
+    _roots.reserve(this->classification());
+    for (const auto& [_k, _n] : this->_nodes) {
+        node_pointer const _m = _rhs._nodes.find(_k);
+        if (!_m) return false;
+        if (_rhs._M_node(_m).value() != this->_M_node(_n).value()) return false;
+        header_pointer const _root = _rhs._M_final_header(_m);
+        const auto [_i, _inserted] = _roots.try_emplace(this->_M_final_header(_n), _root);
+        if (!_inserted && !(_i->second == _root)) return false;
     }
     return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::operator!=(const self& _rhs) const -> bool {
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::operator!=(const self& _rhs) const -> bool {
     return !this->operator==(_rhs);
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::operator[](const key_type& _k) -> mapped_type& {
-    if (!this->contains(_k)) {
-        header_type* const _root = this->_M_allocate_header();
-        node_type* const _n = this->_M_allocate_node();
-        _root->append_node(_n);
-        this->_nodes[_k] = _n;
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::operator[](const key_type& _k) -> mapped_type& {
+    node_pointer _n = this->_nodes.find(_k);
+    if (!_n) {
+        _n = this->_M_allocate_node();
+        header_pointer const _root = this->_M_allocate_alone_header(_n);
+        this->_M_insert_node(_k, _n, _root);
+        this->_M_append_node(_root, _n);
         this->_M_update_final_headers(_root);
+        this->_M_log_added(_k, _n, _root, true);
     }
-    return at(_k);
+    return this->_M_node(_n).value();
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::operator[](const key_type& _k) const -> const mapped_type& {
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::operator[](const key_type& _k) const -> const mapped_type& {
     return at(_k);
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::add(const value_type& _v) -> bool {
-    const key_type& _k = _v.first;
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> template <typename... _Args> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::try_emplace(const key_type& _k, _Args&&... _args) -> bool {
     if (this->contains(_k)) return false;
-    header_type* const _root = this->_M_allocate_header();
-    node_type* const _n = this->_M_allocate_node(_v.second);
-    _root->append_node(_n);
-    this->_nodes[_k] = _n;
+    node_pointer const _n = this->_M_allocate_node(std::forward<_Args>(_args)...);
+    header_pointer const _root = this->_M_allocate_alone_header(_n);
+    this->_M_insert_node(_k, _n, _root);
+    this->_M_append_node(_root, _n);
     this->_M_update_final_headers(_root);
+    this->_M_log_added(_k, _n, _root, true);
     return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::add(const value_type& _v, const key_type& _target) -> bool {
-    const key_type& _k = _v.first;
-    if (this->contains(_k) || !this->contains(_target)) return false;
-    header_type* const _root = this->_M_final_header(this->_nodes.at(_target));
-    node_type* const _n = this->_M_allocate_node(_v.second);
-    _root->append_node(_n);
-    this->_nodes[_k] = _n;
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> template <typename... _Args> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::emplace(const key_type& _k, const key_type& _target, _Args&&... _args) -> bool {
+    if (this->contains(_k)) return false;
+    node_pointer const _t = this->_nodes.find(_target);
+    if (!_t) return false;
+    node_pointer const _n = this->_M_allocate_node(std::forward<_Args>(_args)...);
+    this->_M_insert_node(_k, _n);
+    header_pointer const _root = this->_M_final_header(_t);
+    this->_M_append_node(_root, _n);
     this->_M_update_final_headers(_root);
+    this->_M_log_added(_k, _n, _root, false);
+    return true;
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::update(const key_type& _k, const mapped_type& _m) -> bool {
+    node_pointer const _n = this->_nodes.find(_k);
+    if (!_n) { return false; }
+    this->_M_node(_n).set_value(_m);
     return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::update(const key_type& _k, mapped_type&& _m) -> bool {
-    if (!this->contains(_k)) { return false; }
-    this->_nodes.at(_k)->set_value(std::move(_m));
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::update(const key_type& _k, mapped_type&& _m) -> bool {
+    node_pointer const _n = this->_nodes.find(_k);
+    if (!_n) { return false; }
+    this->_M_node(_n).set_value(std::move(_m));
     return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::at(const key_type& _k) -> mapped_type& {
-    return this->_nodes.at(_k)->value();
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::at(const key_type& _k) -> mapped_type& {
+    return this->_M_node(this->_nodes.at(_k)).value();
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::at(const key_type& _k) const -> const mapped_type& {
-    return this->_nodes.at(_k)->value();
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::at(const key_type& _k) const -> const mapped_type& {
+    return this->_M_node(this->_nodes.at(_k)).value();
 }
 
 
 
 /// protected implementation
-template <typename _Key, typename _Hash, typename _Alloc> auto
-disjoint_set<_Key, _Hash, _Alloc>::_M_assign(const self& _rhs) -> void {
-    std::vector<key_type> _delegate_keys;
-    auto index_of_key = [&](const key_type& _k) -> size_t {
-        for (size_t _i = 0; _i != _delegate_keys.size(); ++_i) {
-            if (_rhs.sibling(_k, _delegate_keys[_i])) return _i;
-        }
-        return _delegate_keys.size();
+/**
+ * @implements T = o(size) expected, S = o(classification)
+ * the final header of each key of `_rhs` is mapped to the final header of its copy
+ */
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_set<_Key, _Hash, _Alloc, _Policy>::_M_assign(const self& _rhs) -> void {
+    this->reserve(_rhs.size(), _rhs.classification());
+    std::unordered_map<header_pointer, header_pointer> _roots;
+    _roots.reserve(_rhs.classification());
+    // the roots are listed at once, so that `clear` releases them if a node fails
+    header_pointer _h = _rhs._final_headers;
+    for (size_t _i = 0; _i != _rhs.classification(); ++_i, _h = _rhs._M_next_root(_h)) {
+        header_pointer& _root = _roots[_h];
+        _root = this->_M_allocate_header();
+        this->_M_link_final_header(_root);
+    }
+    for (const auto& [_k, _m] : _rhs._nodes) {
+        node_pointer const _n = this->_M_allocate_node();
+        this->_M_insert_node(_k, _n);
+        this->_M_append_node(_roots.at(_rhs._M_final_header(_m)), _n);
+    }
+    this->_M_emit(base::change_type::reset, {}, {});
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>::_M_assign(const self& _rhs) -> void {
+    this->reserve(_rhs.size(), _rhs.classification());
+    std::unordered_map<header_pointer, header_pointer> _roots;
+    _roots.reserve(_rhs.classification());
+    // the roots are listed at once, so that `clear` releases them if a node fails
+    header_pointer _h = _rhs._final_headers;
+    for (size_t _i = 0; _i != _rhs.classification(); ++_i, _h = _rhs._M_next_root(_h)) {
+        header_pointer& _root = _roots[_h];
+        _root = this->_M_allocate_header();
+        this->_M_link_final_header(_root);
+    }
+    for (const auto& [_k, _m] : _rhs._nodes) {
+        node_pointer const _n = this->_M_allocate_node(_rhs._M_node(_m).value());
+        this->_M_insert_node(_k, _n);
+        this->_M_append_node(_roots.at(_rhs._M_final_header(_m)), _n);
+    }
+    this->_M_emit(base::change_type::reset, {}, {});
+}
+/**
+ * @brief disjoint set shared by threads, a fixed universe of keys whose classifications are merged concurrently
+ * @tparam _Key type of key object
+ * @tparam _Hash hashing function object type, defaults to std::hash<_Key>.
+ * @tparam _Alloc allocator type, defaults to std::allocator<_Key>.
+ * @tparam _Policy policy type, defaults to disjoint_policy, only its dictionary policy is used
+ * @implements the keys are numbered by a dictionary which is never modified after the construction,
+ * so concurrent lookups are safe, the numbers are united in an `atomic_forest`:
+ * `find`, `sibling` and `merge` are lock-free, the path compression of a lookup is a benign compare-and-swap
+ * @details `disjoint_set` is not thread-safe at all, even its const lookups compress the paths in place
+*/
+template <typename _Key, typename _Hash = std::hash<_Key>, typename _Alloc = std::allocator<_Key>, typename _Policy = disjoint_policy>
+struct concurrent_disjoint_set {
+    using self = concurrent_disjoint_set<_Key, _Hash, _Alloc, _Policy>;
+    using key_type = _Key;
+    using policy_type = _Policy;
+    /// an index is stored plus one, so that 0 stays the absent value
+    using dictionary_type = typename policy_type::dictionary_policy::template type<key_type, size_t, _Hash>;
+    /**
+     * @brief identity of a classification, `npos` for an absent key
+     * @details only stable while no `merge` runs
+     */
+    using class_id = size_t;
+    static constexpr class_id npos = static_cast<class_id>(-1);
+public:
+    /**
+     * @brief each key in a classification of its own, a repeated key is added once
+     */
+    template <std::ranges::input_range _Keys>
+    explicit concurrent_disjoint_set(_Keys&& _keys);
+    concurrent_disjoint_set(std::initializer_list<key_type> _keys) : concurrent_disjoint_set(std::views::all(_keys)) {}
+    concurrent_disjoint_set(const self&) = delete;
+    /// moving is not thread-safe
+    concurrent_disjoint_set(self&& _rhs) noexcept;
+    auto operator=(const self&) -> self& = delete;
+    auto operator=(self&& _rhs) noexcept -> self&;
+    virtual ~concurrent_disjoint_set() = default;
+public:
+    /**
+     * @brief merge 2 classifications, which contains the given 2 keys respectively
+     * @return return false when the keys are not in disjoint set
+     */
+    auto merge(const key_type& _x, const key_type& _y) -> bool;
+    /**
+     * @brief return whether the 2 keys are in the same classification, false when a key is absent
+     * @details linearizable against concurrent `merge`
+     */
+    auto sibling(const key_type& _x, const key_type& _y) const -> bool;
+    /**
+     * @brief return the current root of the classification of the specific key
+     */
+    auto find(const key_type& _k) const -> class_id;
+    auto contains(const key_type& _k) const -> bool { return _index.find(_k) != 0; }
+    auto size() const -> size_t { return _order.size(); }
+    /**
+     * @brief return the number of the classifications, exact once the merges in flight have returned
+     */
+    auto classification() const -> size_t { return _classes.load(std::memory_order_acquire); }
+    /**
+     * @brief copy the current partition into a `disjoint_set`, not to be called while a `merge` runs
+     */
+    auto to_set() const -> disjoint_set<_Key, _Hash, _Alloc, _Policy>;
+private:
+    dictionary_type _index;
+    std::vector<key_type> _order;
+    std::unique_ptr<atomic_forest> _forest;
+    std::atomic<size_t> _classes;
+};
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> template <std::ranges::input_range _Keys>
+concurrent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::concurrent_disjoint_set(_Keys&& _keys) {
+    if constexpr (std::ranges::sized_range<_Keys>) {
+        _index.reserve(std::ranges::size(_keys));
+        _order.reserve(std::ranges::size(_keys));
+    }
+    for (const auto& _k : _keys) {
+        if (_index.find(_k) != 0) continue;
+        _order.push_back(_k);
+        _index.insert(_k, _order.size());
+    }
+    _forest = std::make_unique<atomic_forest>(_order.size());
+    _classes.store(_order.size(), std::memory_order_relaxed);
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy>
+concurrent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::concurrent_disjoint_set(self&& _rhs) noexcept
+    : _index(std::move(_rhs._index)), _order(std::move(_rhs._order)), _forest(std::move(_rhs._forest)),
+      _classes(_rhs._classes.exchange(0, std::memory_order_relaxed)) {}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+concurrent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::operator=(self&& _rhs) noexcept -> self& {
+    _index.swap(_rhs._index);
+    _order.swap(_rhs._order);
+    _forest.swap(_rhs._forest);
+    _classes.store(_rhs._classes.exchange(_classes.load(std::memory_order_relaxed), std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+concurrent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::merge(const key_type& _x, const key_type& _y) -> bool {
+    const size_t _i = _index.find(_x), _j = _index.find(_y);
+    if (_i == 0 || _j == 0) return false;
+    if (_forest->unite(_i - 1, _j - 1)) _classes.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+concurrent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::sibling(const key_type& _x, const key_type& _y) const -> bool {
+    const size_t _i = _index.find(_x), _j = _index.find(_y);
+    if (_i == 0 || _j == 0) return false;
+    return _forest->same(_i - 1, _j - 1);
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+concurrent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::find(const key_type& _k) const -> class_id {
+    const size_t _i = _index.find(_k);
+    if (_i == 0) return npos;
+    return _forest->find(_i - 1);
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+concurrent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::to_set() const -> disjoint_set<_Key, _Hash, _Alloc, _Policy> {
+    std::vector<std::pair<const key_type&, const key_type&>> _edges;
+    _edges.reserve(_order.size());
+    for (size_t _i = 0; _i != _order.size(); ++_i) {
+        const size_t _r = _forest->find(_i);
+        if (_r != _i) _edges.emplace_back(_order[_i], _order[_r]);
+    }
+    return disjoint_set<_Key, _Hash, _Alloc, _Policy>::from_edges(_order, _edges);
+}
+/**
+ * @brief disjoint set partitioned by the hash of the keys into shards, for many writers
+ * @tparam _Key type of key object
+ * @tparam _Hash hashing function object type, defaults to std::hash<_Key>.
+ * @tparam _Alloc allocator type, defaults to std::allocator<_Key>.
+ * @tparam _Policy policy type of the shards, defaults to disjoint_policy.
+ * @implements each shard is a `disjoint_set` under its own mutex, merges within a shard stay in it;
+ * a local classification linked to another shard owns a portal, an index of a small global lock-free
+ * `link_forest`, and merges across shards unite the portals there,
+ * so 2 keys are siblings when they are in the same local classification or their portals are united
+ * @details a merge across shards locks one shard at a time, only to take the root and the portal of its key, and
+ * unites the portals after both are released; a portal is never dropped, the one of an absorbed root is handed to
+ * the new root or united with its portal, so a portal taken earlier still stands for the classification of its key
+*/
+template <typename _Key, typename _Hash = std::hash<_Key>, typename _Alloc = std::allocator<_Key>, typename _Policy = disjoint_policy>
+struct sharded_disjoint_set {
+    using self = sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>;
+    using key_type = _Key;
+    using policy_type = _Policy;
+    using shard_type = disjoint_set<_Key, _Hash, _Alloc, _Policy>;
+public:
+    /**
+     * @param _shards the number of shards, 0 for the hardware threads
+     */
+    explicit sharded_disjoint_set(size_t _n = 0);
+    sharded_disjoint_set(const self&) = delete;
+    auto operator=(const self&) -> self& = delete;
+    virtual ~sharded_disjoint_set() = default;
+public:
+    /**
+     * @brief add the specific key to a new classification
+     * @return return false when the key is already in disjoint set
+     */
+    auto add(const key_type& _k) -> bool;
+    /**
+     * @brief merge 2 classifications, which contains the given 2 keys respectively
+     * @return return false when the keys are not in disjoint set
+     */
+    auto merge(const key_type& _x, const key_type& _y) -> bool;
+    /**
+     * @brief return whether the 2 keys are in the same classification, false when a key is absent
+     */
+    auto sibling(const key_type& _x, const key_type& _y) const -> bool;
+    auto contains(const key_type& _k) const -> bool;
+    /**
+     * @brief return the number of the keys, the shards are locked one by one
+     */
+    auto size() const -> size_t;
+    /**
+     * @brief return the number of the classifications across all shards
+     */
+    auto classification() const -> size_t { return _classes.load(std::memory_order_acquire); }
+    auto shards() const -> size_t { return _shard_count; }
+private:
+    using class_id = typename shard_type::class_id;
+    using portal_type = size_t;
+    static constexpr portal_type no_portal = static_cast<portal_type>(-1);
+    struct alignas(64) shard {
+        mutable std::mutex _lock;
+        shard_type _set;
+        /// the portals of the local classifications plus one, by their root
+        flat_table<class_id, portal_type, std::hash<class_id>> _portals;
     };
-    for (const auto& _i : _rhs._nodes) {
-        const key_type& _k = _i.first;
-        header_type* const _root = [this, &_delegate_keys](const size_t _idx) {
-            if (_idx == _delegate_keys.size()) return this->_M_allocate_header();
-            else return this->_M_final_header_const(this->_nodes.at(_delegate_keys.at(_idx)));
-        } (index_of_key(_k));
-        if (_root->size() == 0) {
-            _delegate_keys.push_back(_k);
-        }
-        node_type* const _n = this->_M_allocate_node();
-        _root->append_node(_n);
-        this->_nodes[_k] = _n;
-        this->_M_update_final_headers(_root);
+    auto _M_shard(const key_type& _k) const -> shard&;
+    /**
+     * @brief the portal of a local classification, a new one is opened if asked, requires the shard mutex
+     */
+    auto _M_portal(shard& _s, class_id _r, bool _open) const -> portal_type;
+    /**
+     * @brief the 2 portals are united, or the one of the absorbed root moves to the new root, requires the shard mutex
+     * @return whether the classifications were apart before
+     */
+    auto _M_merge_local(shard& _s, class_id _x, class_id _y, class_id _root) -> bool;
+private:
+    std::unique_ptr<shard[]> _shards;
+    size_t _shard_count;
+    mutable link_forest _links;
+    std::atomic<size_t> _classes = 0;
+};
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy>
+sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>::sharded_disjoint_set(size_t _n)
+    : _shard_count(std::max<size_t>(1, _n == 0 ? std::thread::hardware_concurrency() : _n)) {
+    _shards = std::make_unique<shard[]>(_shard_count);
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>::_M_shard(const key_type& _k) const -> shard& {
+    // the high bits of the mixed hash pick the shard, the low bits stay evenly spread for the dictionary of the shard
+    const uint64_t _h = static_cast<uint64_t>(_Hash{}(_k)) * 0x9e3779b97f4a7c15ull;
+    return _shards[(_h >> 32) % _shard_count];
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>::_M_portal(shard& _s, class_id _r, bool _open) const -> portal_type {
+    const portal_type _p = _s._portals.find(_r);
+    if (_p != 0) return _p - 1;
+    if (!_open) return no_portal;
+    const portal_type _q = _links.open();
+    _s._portals.insert(_r, _q + 1);
+    return _q;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>::_M_merge_local(shard& _s, class_id _x, class_id _y, class_id _root) -> bool {
+    const class_id _absorbed = (_root == _x ? _y : _x);
+    const portal_type _p = _s._portals.find(_absorbed);
+    if (_p == 0) return true;
+    _s._portals.erase(_absorbed);
+    const portal_type _q = _s._portals.find(_root);
+    if (_q == 0) {
+        _s._portals.insert(_root, _p);
+        return true;
+    }
+    return _links.unite(_p - 1, _q - 1);
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>::add(const key_type& _k) -> bool {
+    shard& _s = _M_shard(_k);
+    std::lock_guard _locked(_s._lock);
+    if (!_s._set.add(_k)) return false;
+    _classes.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>::merge(const key_type& _x, const key_type& _y) -> bool {
+    shard& _sx = _M_shard(_x);
+    shard& _sy = _M_shard(_y);
+    if (&_sx == &_sy) {
+        std::lock_guard _locked(_sx._lock);
+        const class_id _rx = _sx._set.find(_x), _ry = _sx._set.find(_y);
+        if (!_rx || !_ry) return false;
+        if (_rx == _ry) return true;
+        if (_M_merge_local(_sx, _rx, _ry, _sx._set.unite(_rx, _ry))) _classes.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    // a portal opened for @c _x when @c _y is absent is kept, a classification never owns more than one
+    portal_type _px, _py;
+    {
+        std::lock_guard _locked(_sx._lock);
+        const class_id _rx = _sx._set.find(_x);
+        if (!_rx) return false;
+        _px = _M_portal(_sx, _rx, true);
     }
+    {
+        std::lock_guard _locked(_sy._lock);
+        const class_id _ry = _sy._set.find(_y);
+        if (!_ry) return false;
+        _py = _M_portal(_sy, _ry, true);
+    }
+    if (_links.unite(_px, _py)) _classes.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
 }
-template <typename _Key, typename _Value, typename _Hash, typename _Alloc> auto
-disjoint_map<_Key, _Value, _Hash, _Alloc>::_M_assign(const self& _rhs) -> void {
-    std::vector<key_type> _delegate_keys;
-    auto index_of_key = [&](const key_type& _k) -> size_t {
-        for (size_t _i = 0; _i != _delegate_keys.size(); ++_i) {
-            if (_rhs.sibling(_k, _delegate_keys[_i])) return _i;
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>::sibling(const key_type& _x, const key_type& _y) const -> bool {
+    shard& _sx = _M_shard(_x);
+    shard& _sy = _M_shard(_y);
+    portal_type _px, _py;
+    if (&_sx == &_sy) {
+        std::lock_guard _locked(_sx._lock);
+        const class_id _rx = _sx._set.find(_x), _ry = _sx._set.find(_y);
+        if (!_rx || !_ry) return false;
+        if (_rx == _ry) return true;
+        _px = _M_portal(_sx, _rx, false);
+        _py = _M_portal(_sx, _ry, false);
+    }
+    else {
+        // taken one shard at a time: the classifications only grow, so portals united after the first is taken still count
+        {
+            std::lock_guard _locked(_sx._lock);
+            const class_id _rx = _sx._set.find(_x);
+            if (!_rx) return false;
+            _px = _M_portal(_sx, _rx, false);
+        }
+        {
+            std::lock_guard _locked(_sy._lock);
+            const class_id _ry = _sy._set.find(_y);
+            if (!_ry) return false;
+            _py = _M_portal(_sy, _ry, false);
         }
-        return _delegate_keys.size();
+    }
+    if (_px == no_portal || _py == no_portal) return false;
+    return _links.same(_px, _py);
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>::size() const -> size_t {
+    size_t _n = 0;
+    for (size_t _i = 0; _i != _shard_count; ++_i) {
+        std::lock_guard _locked(_shards[_i]._lock);
+        _n += _shards[_i]._set.size();
+    }
+    return _n;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+sharded_disjoint_set<_Key, _Hash, _Alloc, _Policy>::contains(const key_type& _k) const -> bool {
+    shard& _s = _M_shard(_k);
+    std::lock_guard _locked(_s._lock);
+    return _s._set.contains(_k);
+}
+/**
+ * @brief disjoint set keeping every version taken by `snapshot`, the past versions stay queryable
+ * @tparam _Key type of key object
+ * @tparam _Hash hashing function object type, defaults to std::hash<_Key>.
+ * @tparam _Alloc allocator type, defaults to std::allocator<_Key>.
+ * @tparam _Policy policy type, defaults to disjoint_policy, only its dictionary policy is used
+ * @implements partially persistent: the partition is a `versioned_forest` whose links are stamped with the version
+ * they were made in, and each key is bound to an index of the forest by a chain of stamped bindings, so a version is
+ * the current structure read through the stamps; `del` and `join` unbind the key rather than unlink its index,
+ * which stays in the tree for the keys linked below it, and `join` binds the key to a fresh index;
+ * `snapshot` is o(1), a modification adds o(1) indices, links and records, and a query of any version
+ * follows o(log n) links, plus the bindings of the key made after that version
+ * @details only the latest version is modified
+*/
+template <typename _Key, typename _Hash = std::hash<_Key>, typename _Alloc = std::allocator<_Key>, typename _Policy = disjoint_policy>
+struct persistent_disjoint_set {
+    using self = persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>;
+    using key_type = _Key;
+    using policy_type = _Policy;
+    using version_type = versioned_forest::version_type;
+    /// a key slot is stored plus one, so that 0 stays the absent value
+    using dictionary_type = typename policy_type::dictionary_policy::template type<key_type, size_t, _Hash>;
+    /**
+     * @brief read-only view of a version, valid as long as the container
+     */
+    struct snapshot_type {
+        auto version() const -> version_type { return _v; }
+        auto contains(const key_type& _k) const -> bool { return _s->_M_node(_k, _v) != npos; }
+        auto sibling(const key_type& _k) const -> size_t { return _s->_M_sibling(_k, _v); }
+        auto sibling(const key_type& _x, const key_type& _y) const -> bool { return _s->_M_sibling(_x, _y, _v); }
+        auto size() const -> size_t { return _s->_M_counts(_v).first; }
+        auto classification() const -> size_t { return _s->_M_counts(_v).second; }
+        const self* _s;
+        version_type _v;
     };
-    for (const auto& _i : _rhs._nodes) {
-        const key_type& _k = _i.first;
-        header_type* const _root = [this, &_delegate_keys](const size_t _idx) {
-            if (_idx == _delegate_keys.size()) return this->_M_allocate_header();
-            else return this->_M_final_header_const(this->_nodes.at(_delegate_keys.at(_idx)));
-        } (index_of_key(_k));
-        if (_root->size() == 0) {
-            _delegate_keys.push_back(_k);
-        }
-        node_type* const _n = this->_M_allocate_node(_i.second->value());
-        _root->append_node(_n);
-        this->_nodes[_k] = _n;
-        this->_M_update_final_headers(_root);
+public:
+    persistent_disjoint_set() = default;
+    persistent_disjoint_set(std::initializer_list<std::initializer_list<key_type>> _llk);
+    virtual ~persistent_disjoint_set() = default;
+public:
+    /**
+     * @brief freeze the latest version and return it, the modifications go to the next one
+     */
+    auto snapshot() -> snapshot_type;
+    /**
+     * @brief return the version @c _v, a frozen one or the latest one
+     * @details throw `std::out_of_range` when the version is not taken yet
+     */
+    auto at(version_type _v) const -> snapshot_type;
+    /**
+     * @brief return the version being modified, the number of snapshots taken
+     */
+    auto version() const -> version_type { return _now; }
+    auto add(const key_type& _k) -> bool;
+    auto add(const key_type& _k, const key_type& _target) -> bool;
+    auto del(const key_type& _k) -> bool;
+    auto join(const key_type& _k) -> bool;
+    auto join(const key_type& _k, const key_type& _target) -> bool;
+    auto merge(const key_type& _x, const key_type& _y) -> bool;
+    auto contains(const key_type& _k) const -> bool { return _M_node(_k, _now) != npos; }
+    auto sibling(const key_type& _k) const -> size_t { return _M_sibling(_k, _now); }
+    auto sibling(const key_type& _x, const key_type& _y) const -> bool { return _M_sibling(_x, _y, _now); }
+    auto size() const -> size_t { return _size; }
+    auto classification() const -> size_t { return _classes; }
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    /**
+     * @brief the index a key is bound to since a version, `npos` once the key is deleted
+     */
+    struct binding {
+        version_type _since;
+        size_t _node;
+        size_t _prev;
+    };
+    /**
+     * @brief return the index bound to the key as of the version @c _v, `npos` when absent
+     */
+    auto _M_node(const key_type& _k, version_type _v) const -> size_t;
+    /**
+     * @brief bind the key slot to @c _n in the latest version
+     */
+    auto _M_bind(size_t _slot, size_t _n) -> void;
+    /**
+     * @brief take the member away from the current root @c _r, which may be left with no member
+     */
+    auto _M_leave(size_t _r) -> void;
+    auto _M_sibling(const key_type& _k, version_type _v) const -> size_t;
+    auto _M_sibling(const key_type& _x, const key_type& _y, version_type _v) const -> bool;
+    auto _M_counts(version_type _v) const -> std::pair<size_t, size_t> {
+        return _v < _frozen.size() ? _frozen[_v] : std::pair<size_t, size_t>{_size, _classes};
+    }
+private:
+    dictionary_type _index;
+    /// the newest binding of each key slot
+    std::vector<size_t> _heads;
+    std::vector<binding> _bindings;
+    versioned_forest _forest;
+    /// the size and the classifications of each frozen version
+    std::vector<std::pair<size_t, size_t>> _frozen;
+    version_type _now = 0;
+    size_t _size = 0;
+    size_t _classes = 0;
+};
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy>
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::persistent_disjoint_set(std::initializer_list<std::initializer_list<key_type>> _llk) {
+    for (const auto& _lk : _llk) {
+        if (_lk.begin() == _lk.end()) continue;
+        add(*_lk.begin());
+        for (auto _i = _lk.begin() + 1; _i != _lk.end(); ++_i) add(*_i, *_lk.begin());
+    }
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::snapshot() -> snapshot_type {
+    _frozen.emplace_back(_size, _classes);
+    return {this, _now++};
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::at(version_type _v) const -> snapshot_type {
+    if (_v > _now) throw std::out_of_range("version not taken yet");
+    return {this, _v};
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::add(const key_type& _k) -> bool {
+    size_t _slot = _index.find(_k);
+    if (_slot != 0 && _M_node(_k, _now) != npos) return false;
+    if (_slot == 0) {
+        _heads.push_back(npos);
+        _index.insert(_k, _heads.size());
+        _slot = _heads.size();
+    }
+    _M_bind(_slot - 1, _forest.open());
+    ++_size;
+    ++_classes;
+    return true;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::add(const key_type& _k, const key_type& _target) -> bool {
+    const size_t _t = _M_node(_target, _now);
+    if (_t == npos || !add(_k)) return false;
+    // the fresh root of one member is absorbed right away, in the same version
+    const size_t _r = _forest.find(_t, _now);
+    const size_t _root = _forest.link(_r, _M_node(_k, _now), _now);
+    _forest.set_members(_root, _now, _forest.members(_r, _now) + 1);
+    --_classes;
+    return true;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::del(const key_type& _k) -> bool {
+    const size_t _n = _M_node(_k, _now);
+    if (_n == npos) return false;
+    _M_leave(_forest.find(_n, _now));
+    _M_bind(_index.find(_k) - 1, npos);
+    --_size;
+    return true;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::join(const key_type& _k) -> bool {
+    const size_t _n = _M_node(_k, _now);
+    if (_n == npos) return false;
+    const size_t _r = _forest.find(_n, _now);
+    if (_forest.members(_r, _now) == 1) return true;
+    _M_leave(_r);
+    _M_bind(_index.find(_k) - 1, _forest.open());
+    ++_classes;
+    return true;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::join(const key_type& _k, const key_type& _target) -> bool {
+    const size_t _n = _M_node(_k, _now), _t = _M_node(_target, _now);
+    if (_n == npos || _t == npos) return false;
+    const size_t _r = _forest.find(_n, _now), _rt = _forest.find(_t, _now);
+    if (_r == _rt) return true;
+    _M_leave(_r);
+    const size_t _fresh = _forest.open();
+    const size_t _root = _forest.link(_rt, _fresh, _now);
+    _forest.set_members(_root, _now, _forest.members(_rt, _now) + 1);
+    _M_bind(_index.find(_k) - 1, _fresh);
+    return true;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::merge(const key_type& _x, const key_type& _y) -> bool {
+    const size_t _nx = _M_node(_x, _now), _ny = _M_node(_y, _now);
+    if (_nx == npos || _ny == npos) return false;
+    const size_t _rx = _forest.find(_nx, _now), _ry = _forest.find(_ny, _now);
+    if (_rx == _ry) return true;
+    const size_t _members = _forest.members(_rx, _now) + _forest.members(_ry, _now);
+    _forest.set_members(_forest.link(_rx, _ry, _now), _now, _members);
+    --_classes;
+    return true;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::_M_node(const key_type& _k, version_type _v) const -> size_t {
+    const size_t _slot = _index.find(_k);
+    if (_slot == 0) return npos;
+    size_t _b = _heads[_slot - 1];
+    for (; _b != npos && _bindings[_b]._since > _v; _b = _bindings[_b]._prev);
+    return _b == npos ? npos : _bindings[_b]._node;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::_M_bind(size_t _slot, size_t _n) -> void {
+    const size_t _head = _heads[_slot];
+    // no version can see a binding replaced in the version it was made in
+    if (_head != npos && _bindings[_head]._since == _now) {
+        _bindings[_head]._node = _n;
+        return;
     }
+    _bindings.push_back({_now, _n, _head});
+    _heads[_slot] = _bindings.size() - 1;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::_M_leave(size_t _r) -> void {
+    const size_t _members = _forest.members(_r, _now) - 1;
+    _forest.set_members(_r, _now, _members);
+    if (_members == 0) --_classes;
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::_M_sibling(const key_type& _k, version_type _v) const -> size_t {
+    const size_t _n = _M_node(_k, _v);
+    if (_n == npos) return 0;
+    return _forest.members(_forest.find(_n, _v), _v);
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+persistent_disjoint_set<_Key, _Hash, _Alloc, _Policy>::_M_sibling(const key_type& _x, const key_type& _y, version_type _v) const -> bool {
+    const size_t _nx = _M_node(_x, _v);
+    if (_nx == npos) return false;
+    const size_t _ny = _M_node(_y, _v);
+    if (_ny == npos) return false;
+    return _forest.find(_nx, _v) == _forest.find(_ny, _v);
+}
+template <typename _Key, typename _Hash, typename _Alloc, typename _Policy> auto
+swap(disjoint_set<_Key, _Hash, _Alloc, _Policy>& _x, disjoint_set<_Key, _Hash, _Alloc, _Policy>& _y) noexcept -> void {
+    _x.swap(_y);
+}
+template <typename _Key, typename _Value, typename _Hash, typename _Alloc, typename _Policy> auto
+swap(disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>& _x, disjoint_map<_Key, _Value, _Hash, _Alloc, _Policy>& _y) noexcept -> void {
+    _x.swap(_y);
 }
 
 }
 
+template <typename _Tp> struct std::hash<icy::index_pointer<_Tp>> {
+    auto operator()(icy::index_pointer<_Tp> _p) const noexcept -> size_t { return std::hash<uint32_t>()(_p.index()); }
+};
+
 #endif // _ICY_DISJOINT_HPP_
\ No newline at end of file
@@ -0,0 +1,154 @@
+#ifndef _ICY_DISJOINT_MAPPED_HPP_
+#define _ICY_DISJOINT_MAPPED_HPP_
+
+#include "disjoint.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace icy {
+
+/**
+ * @brief read-only view of a container written by `save`, answered from the memory mapped file
+ * @tparam _Key a trivially copyable key, the keys are compared in place in the file
+ * @tparam _Hash must hash as the @c _Hash of the saved container, the saved hash slots are probed by it
+ * @implements nothing is read into memory: a key is found by probing the hash slots of the file and comparing
+ * the keys they point to, the classification of each key and the size of each classification are read in place;
+ * opening checks only the header against the file length, each entry is checked as a query reads it
+ * @details the file is mapped read-only, it must not be modified while it is viewed
+ */
+template <typename _Key, typename _Hash = std::hash<_Key>> requires std::is_trivially_copyable_v<_Key>
+struct mapped_disjoint_set {
+    using self = mapped_disjoint_set<_Key, _Hash>;
+    using key_type = _Key;
+    /**
+     * @brief identity of a classification, its number in the file, `npos` for an absent key
+     */
+    using class_id = size_t;
+    static constexpr class_id npos = static_cast<class_id>(-1);
+    static_assert(alignof(key_type) <= 8, "the sections of the file are aligned to 8 bytes");
+public:
+    /**
+     * @brief map the file, throw `std::runtime_error` when it cannot be mapped, was not saved from this key type,
+     * or its counts do not fit its length
+     */
+    explicit mapped_disjoint_set(const std::filesystem::path& _path);
+    mapped_disjoint_set(const self&) = delete;
+    mapped_disjoint_set(self&& _rhs) noexcept { _M_swap(_rhs); }
+    auto operator=(const self&) -> self& = delete;
+    auto operator=(self&& _rhs) noexcept -> self& { _M_swap(_rhs); return *this; }
+    virtual ~mapped_disjoint_set();
+public:
+    auto contains(const key_type& _k) const -> bool { return _M_position(_k) != npos; }
+    auto size() const -> size_t { return _size; }
+    auto classification() const -> size_t { return _classes; }
+    /**
+     * @brief return the classification of the specific key, `npos` when it is absent
+     * @details the queries throw `std::runtime_error` on a classification or a slot out of range
+     */
+    auto find(const key_type& _k) const -> class_id {
+        const size_t _i = _M_position(_k);
+        if (_i == npos) return npos;
+        if (_class[_i] >= _classes) throw std::runtime_error("the mapped file is corrupted");
+        return _class[_i];
+    }
+    auto sibling(const key_type& _k) const -> size_t {
+        const class_id _c = find(_k);
+        return _c == npos ? 0 : _sizes[_c];
+    }
+    auto sibling(const key_type& _x, const key_type& _y) const -> bool {
+        const class_id _c = find(_x);
+        return _c != npos && _c == find(_y);
+    }
+private:
+    /**
+     * @brief return the position of the key in the file, `npos` when absent
+     */
+    auto _M_position(const key_type& _k) const -> size_t;
+    auto _M_swap(self& _rhs) noexcept -> void {
+        std::swap(_map, _rhs._map);
+        std::swap(_length, _rhs._length);
+        std::swap(_size, _rhs._size);
+        std::swap(_classes, _rhs._classes);
+        std::swap(_class, _rhs._class);
+        std::swap(_sizes, _rhs._sizes);
+        std::swap(_keys, _rhs._keys);
+        std::swap(_slots, _rhs._slots);
+        std::swap(_mask, _rhs._mask);
+    }
+private:
+    void* _map = nullptr;
+    size_t _length = 0;
+    size_t _size = 0;
+    size_t _classes = 0;
+    const archive_index* _class = nullptr;
+    const archive_index* _sizes = nullptr;
+    const key_type* _keys = nullptr;
+    const archive_index* _slots = nullptr;
+    size_t _mask = 0;
+};
+template <typename _Key, typename _Hash> requires std::is_trivially_copyable_v<_Key>
+mapped_disjoint_set<_Key, _Hash>::mapped_disjoint_set(const std::filesystem::path& _path) {
+    const int _fd = ::open(_path.c_str(), O_RDONLY);
+    if (_fd < 0) throw std::runtime_error("cannot open " + _path.string());
+    struct stat _st;
+    if (::fstat(_fd, &_st) != 0 || static_cast<size_t>(_st.st_size) < sizeof(archive_header)) {
+        ::close(_fd);
+        throw std::runtime_error(_path.string() + " is not a saved container of this type");
+    }
+    _length = _st.st_size;
+    _map = ::mmap(nullptr, _length, PROT_READ, MAP_SHARED, _fd, 0);
+    ::close(_fd);
+    if (_map == MAP_FAILED) {
+        _map = nullptr;
+        throw std::runtime_error("cannot map " + _path.string());
+    }
+    const char* const _base = static_cast<const char*>(_map);
+    const archive_header& _head = *reinterpret_cast<const archive_header*>(_base);
+    auto _refuse = [&](const char* _why) {
+        ::munmap(_map, _length);
+        _map = nullptr;
+        throw std::runtime_error(_path.string() + _why);
+    };
+    if (std::memcmp(_head._signature, archive_header::signature, sizeof(_head._signature)) != 0
+        || _head._key_size != sizeof(key_type)) {
+        _refuse(" is not a saved container of this type");
+    }
+    // the counts bound the offsets below, so that they cannot wrap around
+    if (_head._size >= std::numeric_limits<archive_index>::max() || _head._classes > _head._size
+        || _head._slots != archive_capacity(_head._size)) {
+        _refuse(" is corrupted");
+    }
+    const uint64_t _sizes_at = sizeof(archive_header) + archive_align(_head._size * sizeof(archive_index));
+    const uint64_t _keys_at = _sizes_at + archive_align(_head._classes * sizeof(archive_index));
+    const uint64_t _slots_at = _keys_at + archive_align(_head._size * sizeof(key_type));
+    if (_slots_at + _head._slots * sizeof(archive_index) > _length) _refuse(" is truncated");
+    _size = _head._size;
+    _classes = _head._classes;
+    _class = reinterpret_cast<const archive_index*>(_base + sizeof(archive_header));
+    _sizes = reinterpret_cast<const archive_index*>(_base + _sizes_at);
+    _keys = reinterpret_cast<const key_type*>(_base + _keys_at);
+    _slots = reinterpret_cast<const archive_index*>(_base + _slots_at);
+    _mask = _head._slots - 1;
+}
+template <typename _Key, typename _Hash> requires std::is_trivially_copyable_v<_Key>
+mapped_disjoint_set<_Key, _Hash>::~mapped_disjoint_set() {
+    if (_map) ::munmap(_map, _length);
+}
+template <typename _Key, typename _Hash> requires std::is_trivially_copyable_v<_Key> auto
+mapped_disjoint_set<_Key, _Hash>::_M_position(const key_type& _k) const -> size_t {
+    // a free slot ends the probe, at most one pass when the file has none
+    size_t _s = _Hash()(_k) & _mask;
+    for (size_t _n = 0; _n <= _mask && _slots[_s] != 0; ++_n, _s = (_s + 1) & _mask) {
+        if (_slots[_s] > _size) throw std::runtime_error("the mapped file is corrupted");
+        const size_t _i = _slots[_s] - 1;
+        if (_keys[_i] == _k) return _i;
+    }
+    return npos;
+}
+
+}
+
+#endif // _ICY_DISJOINT_MAPPED_HPP_
@@ -0,0 +1,133 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+#include "disjoint_mapped.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+struct flat_index_policy : public icy::disjoint_policy {
+    using storage_policy = icy::index_storage;
+    using dictionary_policy = icy::flat_dictionary;
+};
+struct dense_pool_policy : public icy::dense_policy {
+    using storage_policy = icy::pool_storage;
+    using key_policy = icy::keyed_nodes;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<uint32_t, std::hash<uint32_t>, std::allocator<uint32_t>, _Policy>;
+
+static constexpr uint32_t _n = 5000;
+
+/**
+ * @brief overwrite the field of the file at @c _offset
+ */
+template <typename _Tp = uint64_t> void patch(const std::filesystem::path& _path, std::streamoff _offset, _Tp _v) {
+    std::fstream _f(_path, std::ios::binary | std::ios::in | std::ios::out);
+    _f.seekp(_offset);
+    _f.write(reinterpret_cast<const char*>(&_v), sizeof(_v));
+}
+
+template <typename _Set> void round_trip(const std::filesystem::path& _path) {
+    std::mt19937 _gen(_n);
+    std::uniform_int_distribution<uint32_t> _key(0, _n - 1);
+    _Set _s;
+    for (uint32_t _i = 0; _i != _n; ++_i) _s.add(_i);
+    for (uint32_t _i = 0; _i != _n; ++_i) _s.merge(_key(_gen), _key(_gen));
+    for (uint32_t _i = 0; _i != _n / 10; ++_i) _s.del(_key(_gen));
+    _s.save(_path);
+    const _Set _t = _Set::load(_path);
+    EXPECT_TRUE(_t == _s);
+    EXPECT_EQ(_t.classification(), _s.classification());
+    EXPECT_EQ(_t.height(), 1);
+    EXPECT_NOTHROW(_t.check());
+    // the mapped file answers as the container
+    const icy::mapped_disjoint_set<uint32_t> _m(_path);
+    EXPECT_EQ(_m.size(), _s.size());
+    EXPECT_EQ(_m.classification(), _s.classification());
+    for (uint32_t _i = 0; _i != _n; ++_i) {
+        EXPECT_EQ(_m.contains(_i), _s.contains(_i));
+        EXPECT_EQ(_m.sibling(_i), _s.sibling(_i));
+        const uint32_t _j = _key(_gen);
+        EXPECT_EQ(_m.sibling(_i, _j), _s.sibling(_i, _j));
+    }
+    EXPECT_FALSE(_m.contains(_n));
+}
+
+int main(void) {
+    const auto _path = std::filesystem::temp_directory_path() / "icy_archive.dsj";
+    round_trip<icy::disjoint_set<uint32_t>>(_path);
+    round_trip<set_type<flat_index_policy>>(_path);
+    round_trip<set_type<dense_pool_policy>>(_path);
+
+    // empty
+    icy::disjoint_set<uint32_t> _empty;
+    _empty.save(_path);
+    EXPECT_TRUE(icy::disjoint_set<uint32_t>::load(_path).empty());
+    EXPECT_FALSE(icy::mapped_disjoint_set<uint32_t>(_path).contains(0));
+
+    // a file of another type, or cut short, is refused
+    icy::disjoint_map<uint32_t, std::string> _map {{{1, "one"}, {2, "two"}}, {{3, "three"}}};
+    _map.save(_path);
+    EXPECT_TRUE((icy::disjoint_map<uint32_t, std::string>::load(_path) == _map));
+    EXPECT_THROW(std::runtime_error, icy::disjoint_set<uint32_t>::load(_path));
+    EXPECT_THROW(std::runtime_error, (icy::disjoint_map<uint32_t, uint32_t>::load(_path)));
+    EXPECT_THROW(std::runtime_error, icy::mapped_disjoint_set<uint64_t>{_path});
+    EXPECT_TRUE(icy::mapped_disjoint_set<uint32_t>(_path).sibling(1, 2));
+    std::filesystem::resize_file(_path, std::filesystem::file_size(_path) - 8);
+    EXPECT_THROW(std::runtime_error, (icy::disjoint_map<uint32_t, std::string>::load(_path)));
+    // counts beyond the file are refused before anything is allocated by them
+    static constexpr std::streamoff _size_at = 32, _classes_at = 40, _slots_at = 48;
+    round_trip<icy::disjoint_set<uint32_t>>(_path);
+    patch(_path, _size_at, uint64_t(1) << 31);
+    EXPECT_THROW(std::runtime_error, icy::disjoint_set<uint32_t>::load(_path));
+    patch(_path, _slots_at, uint64_t(1) << 32);
+    EXPECT_THROW(std::runtime_error, icy::disjoint_set<uint32_t>::load(_path));
+    patch(_path, _size_at, ~uint64_t(0));
+    EXPECT_THROW(std::runtime_error, icy::disjoint_set<uint32_t>::load(_path));
+    EXPECT_THROW(std::runtime_error, icy::mapped_disjoint_set<uint32_t>{_path});
+    round_trip<icy::disjoint_set<uint32_t>>(_path);
+    patch(_path, _classes_at, _n + 1);
+    EXPECT_THROW(std::runtime_error, icy::disjoint_set<uint32_t>::load(_path));
+    // a classification or a slot out of range is refused by the mapped view when a query reads it
+    icy::disjoint_set<uint32_t> _pairs {{1, 2}, {3}};
+    _pairs.save(_path);
+    patch<uint32_t>(_path, sizeof(icy::archive_header), 2);
+    {
+        const icy::mapped_disjoint_set<uint32_t> _m(_path);
+        EXPECT_THROW(std::runtime_error, (void)(_m.sibling(1) + _m.sibling(2) + _m.sibling(3)));
+    }
+    EXPECT_THROW(std::runtime_error, icy::disjoint_set<uint32_t>::load(_path));
+    _pairs.save(_path);
+    // classes, sizes and keys of 3, 2 and 3 entries, each padded to 8 bytes, then 8 slots
+    const std::streamoff _slot_at = sizeof(icy::archive_header) + 16 + 8 + 16;
+    for (std::streamoff _s = 0; _s != 8; ++_s) patch<uint32_t>(_path, _slot_at + 4 * _s, 4);
+    EXPECT_THROW(std::runtime_error, icy::mapped_disjoint_set<uint32_t>(_path).contains(1));
+    // without a free slot a probe still ends
+    for (std::streamoff _s = 0; _s != 8; ++_s) patch<uint32_t>(_path, _slot_at + 4 * _s, 1);
+    EXPECT_FALSE(icy::mapped_disjoint_set<uint32_t>(_path).contains(7));
+    _pairs.save(_path);
+    patch(_path, _classes_at, 4);
+    EXPECT_THROW(std::runtime_error, icy::mapped_disjoint_set<uint32_t>{_path});
+    // a key met twice is refused by the loader
+    _pairs.save(_path);
+    const std::streamoff _key_at = sizeof(icy::archive_header) + 16 + 8;
+    uint32_t _first = 0;
+    std::ifstream(_path, std::ios::binary).seekg(_key_at).read(reinterpret_cast<char*>(&_first), sizeof(_first));
+    patch<uint32_t>(_path, _key_at + 4, _first);
+    EXPECT_THROW(std::runtime_error, icy::disjoint_set<uint32_t>::load(_path));
+    EXPECT_THROW(std::runtime_error, set_type<flat_index_policy>::load(_path));
+    EXPECT_THROW(std::runtime_error, set_type<dense_pool_policy>::load(_path));
+    _pairs.save(_path);
+    EXPECT_TRUE(icy::mapped_disjoint_set<uint32_t>(_path).sibling(1, 2));
+    _map.save(_path);
+    patch(_path, _size_at, uint64_t(1) << 30);
+    EXPECT_THROW(std::runtime_error, (icy::disjoint_map<uint32_t, std::string>::load(_path)));
+    std::filesystem::remove(_path);
+    EXPECT_THROW(std::runtime_error, icy::disjoint_set<uint32_t>::load(_path));
+    EXPECT_THROW(std::runtime_error, icy::mapped_disjoint_set<uint32_t>{_path});
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+struct ordered_node_policy : public icy::disjoint_policy {
+    using merge_policy = icy::merge_by_order;
+    using compress_policy = icy::compress_node;
+};
+struct ordered_flat_policy : public icy::disjoint_policy {
+    using merge_policy = icy::merge_by_order;
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+};
+struct ordered_dense_policy : public icy::dense_policy {
+    using merge_policy = icy::merge_by_order;
+    using storage_policy = icy::pool_storage;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+
+/**
+ * @brief the batched queries agree with `sibling` on deep trees, absent keys included
+ */
+template <typename _Set> void agree(unsigned _seed) {
+    static constexpr unsigned _n = 2000;
+    std::mt19937 _gen(_seed);
+    std::uniform_int_distribution<unsigned> _key(0, _n + _n / 4);
+    _Set _s;
+    for (unsigned _i = 0; _i != _n; ++_i) EXPECT_TRUE(_s.add(_i));
+    for (unsigned _i = 0; _i != _n; ++_i) _s.merge(_key(_gen) % _n, _key(_gen) % _n);
+    // a copy is never queried, so its paths stay as long as they were built
+    const _Set _deep = _s;
+    std::vector<std::pair<unsigned, unsigned>> _pairs(_n * 3 + 5);
+    for (auto& _p : _pairs) _p = {_key(_gen), _key(_gen)};
+    _pairs.emplace_back(_n + 1, _n + 1);
+    _pairs.emplace_back(7, 7);
+    std::vector<bool> _batched;
+    _s.sibling_batch(_pairs, std::back_inserter(_batched));
+    EXPECT_EQ(_batched.size(), _pairs.size());
+    for (size_t _i = 0; _i != _pairs.size(); ++_i) {
+        EXPECT_EQ(_batched[_i], _deep.sibling(_pairs[_i].first, _pairs[_i].second));
+    }
+    EXPECT_NOTHROW(_s.check());
+    EXPECT_EQ(_s, _deep);
+    std::vector<unsigned> _keys(_n + 3);
+    for (auto& _k : _keys) _k = _key(_gen);
+    std::vector<typename _Set::class_id> _ids(_keys.size());
+    EXPECT_EQ(_s.find_batch(_keys, _ids.begin()), _ids.end());
+    for (size_t _i = 0; _i != _keys.size(); ++_i) {
+        EXPECT_EQ(!_ids[_i], !_s.contains(_keys[_i]));
+        for (size_t _j = _i % 7; _j < _keys.size(); _j += 97) {
+            if (_ids[_i] && _ids[_j]) EXPECT_EQ(_ids[_i] == _ids[_j], _s.sibling(_keys[_i], _keys[_j]));
+        }
+    }
+    EXPECT_NOTHROW(_s.check());
+}
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 4; ++_seed) {
+        agree<set_type<icy::disjoint_policy>>(_seed);
+        agree<set_type<ordered_node_policy>>(_seed);
+        agree<set_type<ordered_flat_policy>>(_seed);
+        agree<set_type<ordered_dense_policy>>(_seed);
+    }
+    set_type<icy::disjoint_policy> _empty;
+    std::vector<std::pair<unsigned, unsigned>> _none;
+    std::vector<bool> _out;
+    _empty.sibling_batch(_none, std::back_inserter(_out));
+    EXPECT_TRUE(_out.empty());
+    _empty.sibling_batch(std::vector<std::pair<unsigned, unsigned>> {{1, 1}}, std::back_inserter(_out));
+    EXPECT_EQ(_out, std::vector<bool> {false});
+    return 0;
+}
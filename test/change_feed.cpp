@@ -0,0 +1,279 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct ring_policy : public icy::disjoint_policy {
+    using feed_policy = icy::ring_feed<1 << 16>;
+};
+struct reversible_ring_policy : public ring_policy {
+    using compress_policy = icy::compress_none;
+};
+struct small_ring_policy : public icy::disjoint_policy {
+    using feed_policy = icy::ring_feed<8>;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+
+static constexpr unsigned _n = 64;
+
+static_assert(!icy::disjoint_set<unsigned>::feeding);
+static_assert(set_type<ring_policy>::feeding);
+static_assert(std::is_nothrow_move_constructible_v<set_type<ring_policy>>);
+
+/**
+ * @brief the partition as seen by a consumer, kept up to date by the changes alone
+ */
+template <typename _Set> struct mirror {
+    using class_id = typename _Set::class_id;
+    using change_type = typename _Set::change_type;
+    auto apply(const _Set& _s, const change_type& _c) -> void {
+        switch (_c._kind) {
+        case change_type::merged:
+            for (unsigned _k : _classes[_c._from]) {
+                _classes[_c._to].insert(_k);
+                _owner[_k] = _c._to;
+            }
+            _classes.erase(_c._from);
+            break;
+        case change_type::moved:
+            if (auto _i = _classes.find(_c._from); _i != _classes.end()) _i->second.erase(_c._key);
+            _owner.erase(_c._key);
+            if (_c._to) {
+                _classes[_c._to].insert(_c._key);
+                _owner[_c._key] = _c._to;
+            }
+            break;
+        case change_type::deleted_class:
+            for (unsigned _k : _classes[_c._from]) _owner.erase(_k);
+            _classes.erase(_c._from);
+            break;
+        case change_type::reset:
+            ++_resets;
+            _owner.clear();
+            _classes.clear();
+            for (unsigned _k = 0; _k != _n; ++_k) {
+                if (!_s.contains(_k)) continue;
+                _owner[_k] = _s.find(_k);
+                _classes[_s.find(_k)].insert(_k);
+            }
+            break;
+        }
+    }
+    auto drain(const _Set& _s) -> void {
+        for (change_type _c; _s.poll(_c);) apply(_s, _c);
+    }
+    auto expect_same(const _Set& _s) const -> void {
+        EXPECT_EQ(_owner.size(), _s.size());
+        EXPECT_EQ(_classes.size(), _s.classification());
+        for (unsigned _k = 0; _k != _n; ++_k) {
+            const auto _i = _owner.find(_k);
+            EXPECT_EQ(_i != _owner.end(), _s.contains(_k));
+            if (_i == _owner.end()) continue;
+            EXPECT_TRUE(_i->second == _s.find(_k));
+            EXPECT_EQ(_classes.at(_i->second).size(), _s.sibling(_k));
+        }
+    }
+    std::unordered_map<unsigned, class_id> _owner;
+    std::unordered_map<class_id, std::set<unsigned>> _classes;
+    size_t _resets = 0;
+};
+
+template <typename _Set, typename _Gen> void mutate(_Set& _s, _Gen& _gen) {
+    std::uniform_int_distribution<unsigned> _key(0, _n - 1);
+    const unsigned _x = _key(_gen), _y = _key(_gen);
+    switch (_gen() % 20) {
+    case 0: case 1: case 2: case 3: _s.add(_x); break;
+    case 4: case 5: _s.add(_x, _y); break;
+    case 6: case 7: _s.del(_x); break;
+    case 8: _s.del_all(_x); break;
+    case 9: _s.del_except(_x); break;
+    case 10: case 11: _s.join(_x); break;
+    case 12: case 13: _s.join(_x, _y); break;
+    case 14: _s.merge_batch(std::vector<std::pair<unsigned, unsigned>> {{_x, _y}, {_y, _key(_gen)}}); break;
+    default: _s.merge(_x, _y); break;
+    }
+}
+
+int main(void) {
+    std::mt19937 _gen(_n);
+    {
+        // a mirror kept by the changes matches the container after every few modifications
+        set_type<ring_policy> _s;
+        mirror<set_type<ring_policy>> _m;
+        for (unsigned _round = 0; _round != 500; ++_round) {
+            for (unsigned _i = 0; _i != 10; ++_i) mutate(_s, _gen);
+            _m.drain(_s);
+            _m.expect_same(_s);
+        }
+        EXPECT_EQ(_m._resets, 0);
+        _s.compress();
+        _s.clear();
+        _m.drain(_s);
+        EXPECT_EQ(_m._resets, 1);
+        _m.expect_same(_s);
+    }
+    {
+        // the events of the backlog, in order
+        set_type<ring_policy> _s;
+        using change_type = set_type<ring_policy>::change_type;
+        change_type _c;
+        _s.add(1);
+        _s.add(2, 1);
+        _s.add(3);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::moved && _c._key == 1 && !_c._from && _c._to == _s.find(1));
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::moved && _c._key == 2 && _c._to == _s.find(1));
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::moved && _c._key == 3);
+        const auto _a = _s.find(1), _b = _s.find(3);
+        _s.merge(1, 3);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::merged && _c._from == _b && _c._to == _a);
+        _s.join(3);
+        const auto _j = _s.find(3);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::moved && _c._key == 3 && _c._from == _a && _c._to == _j);
+        _s.del(3);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::moved && _c._key == 3 && _c._from == _j && !_c._to);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::deleted_class && _c._from == _j);
+        // nothing changes, nothing is reported
+        _s.add(9);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::moved && _c._key == 9);
+        const auto _alone = _s.find(9);
+        EXPECT_TRUE(_s.join(9));
+        EXPECT_TRUE(_s.find(9) == _alone);
+        EXPECT_FALSE(_s.poll(_c));
+        _s.del(9);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::moved && _c._key == 9 && !_c._to);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::deleted_class && _c._from == _alone);
+        _s.merge(1, 2);
+        _s.merge(7, 8);
+        _s.join(2, 1);
+        _s.compress();
+        EXPECT_FALSE(_s.poll(_c));
+        _s.del_all(1);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::deleted_class && _c._from == _a);
+        EXPECT_FALSE(_s.poll(_c));
+    }
+    {
+        // a rollback and a swap are reported as resets
+        set_type<reversible_ring_policy> _s, _t;
+        mirror<set_type<reversible_ring_policy>> _m;
+        for (unsigned _i = 0; _i != 100; ++_i) mutate(_s, _gen);
+        _m.drain(_s);
+        const auto _c = _s.checkpoint();
+        for (unsigned _k = 0; _k != _n; ++_k) _s.join(_k, (_k * 7) % _n);
+        _s.rollback(_c);
+        _m.drain(_s);
+        EXPECT_EQ(_m._resets, 1);
+        _m.expect_same(_s);
+        _s.swap(_t);
+        _m.drain(_s);
+        EXPECT_EQ(_m._resets, 2);
+        _m.expect_same(_s);
+    }
+    {
+        // the last slot of a full ring holds a reset for the dropped changes, seen even if the writer stays idle
+        using change_type = set_type<small_ring_policy>::change_type;
+        set_type<small_ring_policy> _s;
+        for (unsigned _k = 0; _k != 20; ++_k) _s.add(_k);
+        change_type _c;
+        for (unsigned _k = 0; _k != 7; ++_k) EXPECT_TRUE(_s.poll(_c) && _c._key == _k);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::reset);
+        EXPECT_FALSE(_s.poll(_c));
+        // once taken, the changes are pushed again, and a reset not taken yet stands for them even with room
+        _s.merge(0, 1);
+        for (unsigned _k = 20; _k != 26; ++_k) _s.add(_k);
+        _s.merge(2, 3);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::merged);
+        _s.add(26);
+        _s.add(27);
+        for (unsigned _k = 20; _k != 26; ++_k) EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::moved && _c._key == _k);
+        EXPECT_TRUE(_s.poll(_c) && _c._kind == change_type::reset);
+        EXPECT_FALSE(_s.poll(_c));
+        // the mirror resynchronised at the reset matches after every burst, drained or not
+        mirror<set_type<small_ring_policy>> _m;
+        _m.apply(_s, {change_type::reset});
+        for (unsigned _round = 0; _round != 200; ++_round) {
+            const unsigned _burst = _gen() % 16;
+            for (unsigned _i = 0; _i != _burst; ++_i) mutate(_s, _gen);
+            _m.drain(_s);
+            _m.expect_same(_s);
+        }
+        EXPECT_TRUE(_m._resets > 1);
+    }
+    {
+        // the contents replaced at once are reported as a reset, even when nothing was there before
+        using type = set_type<ring_policy>;
+        using change_type = type::change_type;
+        type _s;
+        for (unsigned _k = 0; _k != 3; ++_k) _s.add(_k, 0u);
+        change_type _c;
+        while (_s.poll(_c));
+        type _t;
+        mirror<type> _m;
+        _t = _s;
+        _m.drain(_t);
+        EXPECT_TRUE(_m._resets != 0);
+        _m.expect_same(_t);
+        const type _u(_s);
+        EXPECT_TRUE(_u.poll(_c) && _c._kind == change_type::reset);
+        EXPECT_FALSE(_u.poll(_c));
+        const std::vector<unsigned> _keys {0, 1, 2, 3};
+        const std::vector<std::pair<unsigned, unsigned>> _edges {{0, 1}, {2, 3}};
+        const type _e = type::from_edges(_keys, _edges);
+        EXPECT_TRUE(_e.poll(_c) && _c._kind == change_type::reset);
+        EXPECT_FALSE(_e.poll(_c));
+        const auto _path = std::filesystem::temp_directory_path() / "icy_change_feed.dsj";
+        _s.save(_path);
+        const type _l = type::load(_path);
+        std::filesystem::remove(_path);
+        EXPECT_TRUE(_l.poll(_c) && _c._kind == change_type::reset);
+        EXPECT_FALSE(_l.poll(_c));
+        type _empty;
+        _empty.clear();
+        EXPECT_TRUE(_empty.poll(_c) && _c._kind == change_type::reset);
+    }
+    {
+        // a moved-to container takes over the ring with the changes not taken yet, the moved-from one reports nothing
+        using type = set_type<ring_policy>;
+        using change_type = type::change_type;
+        type _s;
+        _s.add(1);
+        type _t(std::move(_s));
+        change_type _c;
+        EXPECT_TRUE(_t.poll(_c) && _c._kind == change_type::moved && _c._key == 1);
+        _s.add(2);
+        EXPECT_FALSE(_s.poll(_c));
+        _t.add(3);
+        mirror<type> _m;
+        _m.apply(_t, {change_type::reset});
+        _m.drain(_t);
+        _m.expect_same(_t);
+    }
+    {
+        // one consumer thread polls while the writer merges
+        set_type<ring_policy> _s;
+        for (unsigned _k = 0; _k != 20000; ++_k) _s.add(_k);
+        set_type<ring_policy>::change_type _c;
+        while (_s.poll(_c));
+        std::atomic<bool> _done {false};
+        size_t _merged = 0;
+        std::thread _consumer([&]() {
+            for (bool _last = false; !_last;) {
+                _last = _done.load(std::memory_order_acquire);
+                for (set_type<ring_policy>::change_type _e; _s.poll(_e);) _merged += (_e._kind == set_type<ring_policy>::change_type::merged);
+            }
+        });
+        std::uniform_int_distribution<unsigned> _key(0, 19999);
+        for (unsigned _i = 0; _i != 20000; ++_i) _s.merge(_key(_gen), _key(_gen));
+        _done.store(true, std::memory_order_release);
+        _consumer.join();
+        EXPECT_EQ(_merged, 20000 - _s.classification());
+    }
+    return 0;
+}
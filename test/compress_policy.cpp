@@ -0,0 +1,110 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+struct node_policy : public icy::disjoint_policy {
+    using merge_policy = icy::merge_by_order;
+    using compress_policy = icy::compress_node;
+};
+struct path_policy : public icy::disjoint_policy {
+    using merge_policy = icy::merge_by_order;
+    using compress_policy = icy::compress_path;
+};
+struct none_policy : public icy::disjoint_policy {
+    using merge_policy = icy::merge_by_order;
+    using compress_policy = icy::compress_none;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+
+static constexpr unsigned _n = 1u << 10;
+static constexpr unsigned _log_n = 10u;
+
+/**
+ * @brief build a chain of `_n` headers, each header holds key `_i` and key `_i + _n`
+ */
+template <typename _Set> void chain(_Set& _s) {
+    for (unsigned _i = 0; _i != _n; ++_i) {
+        EXPECT_TRUE(_s.add(_i));
+        EXPECT_TRUE(_s.add(_i + _n, _i));
+    }
+    for (unsigned _i = 1; _i != _n; ++_i) {
+        EXPECT_TRUE(_s.merge(_i, _i - 1));
+    }
+    EXPECT_EQ(_s.height(), _n);
+    EXPECT_NOTHROW(_s.check());
+}
+
+int main(void) {
+    set_type<node_policy> _node;
+    chain(_node);
+    // the deepest header still holds `_n`, so the chain is untouched
+    EXPECT_EQ(_node.sibling(0u), 2 * _n);
+    EXPECT_EQ(_node.height(), _n);
+    for (unsigned _i = 0; _i != _n; ++_i) {
+        EXPECT_TRUE(_node.sibling(_i, _n - 1));
+    }
+    EXPECT_EQ(_node.height(), _n);
+    EXPECT_NOTHROW(_node.check());
+
+    set_type<path_policy> _path;
+    chain(_path);
+    EXPECT_EQ(_path.sibling(0u), 2 * _n);
+    EXPECT_LE(_path.height(), _n / 2 + 1);
+    EXPECT_NOTHROW(_path.check());
+    for (unsigned _i = 0; _i != _n; ++_i) {
+        EXPECT_TRUE(_path.sibling(_i, _n - 1));
+    }
+    EXPECT_LE(_path.height(), _log_n);
+    EXPECT_NOTHROW(_path.check());
+    // the counters survive re-parenting
+    for (unsigned _i = 0; _i != _n; _i += 2) {
+        EXPECT_TRUE(_path.del(_i + _n));
+    }
+    EXPECT_EQ(_path.sibling(1u), 2 * _n - _n / 2);
+    EXPECT_TRUE(_path.join(1u));
+    EXPECT_TRUE(_path.join(_n + 1, 1u));
+    EXPECT_EQ(_path.sibling(1u), 2);
+    EXPECT_EQ(_path.classification(), 2);
+    EXPECT_NOTHROW(_path.check());
+    EXPECT_TRUE(_path.del_except(3u));
+    EXPECT_EQ(_path.size(), 3);
+    EXPECT_NOTHROW(_path.check());
+
+    set_type<none_policy> _none;
+    chain(_none);
+    // readers share the set under a shared lock, the queries leave the chain untouched
+    std::shared_mutex _lock;
+    {
+        std::vector<std::jthread> _readers;
+        for (unsigned _t = 0; _t != 4; ++_t) {
+            _readers.emplace_back([&_none, &_lock, _t]() {
+                std::shared_lock _reading(_lock);
+                for (unsigned _i = _t; _i < _n; _i += 4) {
+                    EXPECT_TRUE(_none.sibling(_i, _n - 1));
+                    EXPECT_EQ(_none.sibling(_i + _n), 2 * _n);
+                }
+            });
+        }
+    }
+    EXPECT_EQ(_none.height(), _n);
+    EXPECT_NOTHROW(_none.check());
+    {
+        std::unique_lock _writing(_lock);
+        EXPECT_TRUE(_none.compress(0u));
+        EXPECT_FALSE(_none.compress(2 * _n));
+    }
+    EXPECT_LE(_none.height(), _n / 2 + 1);
+    EXPECT_NOTHROW(_none.check());
+    _none.compress();
+    EXPECT_EQ(_none.height(), 1);
+    EXPECT_EQ(_none.sibling(_n - 1), 2 * _n);
+    EXPECT_EQ(_none.classification(), 1);
+    EXPECT_NOTHROW(_none.check());
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct flat_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+};
+template <typename _Policy> using concurrent_type = icy::concurrent_disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+
+/**
+ * @brief threads merge and query at once, a merged pair stays sibling,
+ * and the final partition is the one of the same merges applied one by one
+ */
+template <typename _Policy> void stress(unsigned _seed, unsigned _threads) {
+    static constexpr unsigned _keys = 20000, _edges = 16000;
+    std::mt19937 _gen(_seed);
+    std::uniform_int_distribution<unsigned> _key(0, _keys + 100);
+    std::vector<unsigned> _k;
+    for (unsigned _i = 0; _i != _keys; ++_i) _k.push_back(_i);
+    std::vector<std::pair<unsigned, unsigned>> _e;
+    for (unsigned _i = 0; _i != _edges; ++_i) _e.emplace_back(_key(_gen), _key(_gen));
+    concurrent_type<_Policy> _s(_k);
+    EXPECT_EQ(_s.size(), _keys);
+    std::atomic<bool> _done = false;
+    std::atomic<size_t> _violations = 0;
+    {
+        std::vector<std::jthread> _workers;
+        for (unsigned _t = 0; _t != _threads; ++_t) {
+            _workers.emplace_back([&, _t]() {
+                for (size_t _i = _t; _i < _e.size(); _i += _threads) {
+                    const auto [_x, _y] = _e[_i];
+                    const bool _known = _s.contains(_x) && _s.contains(_y);
+                    if (_s.merge(_x, _y) != _known) ++_violations;
+                    if (_known && !_s.sibling(_x, _y)) ++_violations;
+                    if (_known && _s.find(_x) == icy::concurrent_disjoint_set<unsigned>::npos) ++_violations;
+                }
+            });
+        }
+        // a reader racing the writers, what was sibling once is sibling forever
+        _workers.emplace_back([&]() {
+            std::mt19937 _rgen(_seed + 1);
+            std::vector<std::pair<unsigned, unsigned>> _seen;
+            while (!_done.load()) {
+                const unsigned _x = _key(_rgen), _y = _key(_rgen);
+                if (_s.sibling(_x, _y)) _seen.emplace_back(_x, _y);
+                if (_s.classification() > _keys) ++_violations;
+            }
+            for (const auto& [_x, _y] : _seen) {
+                if (!_s.sibling(_x, _y)) ++_violations;
+            }
+        });
+        for (unsigned _t = 0; _t != _threads; ++_t) _workers[_t].join();
+        _done.store(true);
+    }
+    EXPECT_EQ(_violations.load(), 0);
+    set_type<_Policy> _expected;
+    for (unsigned _i : _k) _expected.add(_i);
+    for (const auto& [_x, _y] : _e) _expected.merge(_x, _y);
+    EXPECT_EQ(_s.classification(), _expected.classification());
+    const set_type<_Policy> _copy = _s.to_set();
+    EXPECT_EQ(_copy, _expected);
+    EXPECT_NOTHROW(_copy.check());
+    for (unsigned _i = 0; _i < _keys; _i += 37) {
+        EXPECT_EQ(_s.sibling(_i, _i + 1), _expected.sibling(_i, _i + 1));
+        EXPECT_EQ(_s.find(_i) == _s.find(_i + 1), _expected.sibling(_i, _i + 1));
+    }
+}
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 3; ++_seed) {
+        stress<icy::disjoint_policy>(_seed, 4);
+        stress<flat_policy>(_seed, 8);
+        stress<icy::dense_policy>(_seed, 2);
+    }
+    icy::concurrent_disjoint_set<std::string> _world {"ger", "ita", "jap", "eng", "usa", "sov", "ger"};
+    EXPECT_EQ(_world.size(), 6);
+    EXPECT_EQ(_world.classification(), 6);
+    EXPECT_TRUE(_world.merge("ger", "ita"));
+    EXPECT_TRUE(_world.merge("jap", "ita"));
+    EXPECT_TRUE(_world.merge("jap", "ger"));
+    EXPECT_FALSE(_world.merge("fra", "eng"));
+    EXPECT_EQ(_world.classification(), 4);
+    EXPECT_TRUE(_world.sibling("ger", "jap"));
+    EXPECT_FALSE(_world.sibling("ger", "usa"));
+    EXPECT_FALSE(_world.sibling("fra", "fra"));
+    EXPECT_EQ(_world.find("fra"), _world.npos);
+    icy::concurrent_disjoint_set<std::string> _moved = std::move(_world);
+    EXPECT_EQ(_moved.classification(), 4);
+    EXPECT_EQ(_moved.to_set().sibling("jap"), 3);
+    return 0;
+}
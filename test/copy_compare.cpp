@@ -0,0 +1,101 @@
+#include "main.hpp"
+#include "reference.hpp"
+
+#include "disjoint.hpp"
+
+#include <new>
+#include <string>
+
+struct index_policy : public icy::disjoint_policy {
+    using storage_policy = icy::index_storage;
+};
+using index_set = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, index_policy>;
+
+/// allocations left before `budget_allocator` throws, negative for no limit
+static long budget = -1;
+/// blocks allocated by `budget_allocator` and not released yet
+static long live = 0;
+/**
+ * @brief allocator that throws `std::bad_alloc` once the budget is spent
+ */
+template <typename _Tp> struct budget_allocator {
+    using value_type = _Tp;
+    budget_allocator() = default;
+    template <typename _Up> budget_allocator(const budget_allocator<_Up>&) {}
+    auto allocate(size_t _n) -> _Tp* {
+        if (budget == 0) throw std::bad_alloc();
+        if (budget > 0) --budget;
+        ++live;
+        return std::allocator<_Tp>().allocate(_n);
+    }
+    auto deallocate(_Tp* _p, size_t _n) -> void { --live; std::allocator<_Tp>().deallocate(_p, _n); }
+    template <typename _Up> bool operator==(const budget_allocator<_Up>&) const { return true; }
+};
+
+/**
+ * @brief a node that cannot be copied leaves no header behind
+ */
+template <typename _Set> void out_of_memory(const _Set& _src) {
+    const long _held = live;
+    // a copy allocates one header per classification and one node per key
+    for (long _b = 0; _b != static_cast<long>(_src.size() + _src.classification()); ++_b) {
+        budget = _b;
+        EXPECT_THROW(std::bad_alloc, _Set{_src});
+        budget = -1;
+        _Set _t = _src;
+        budget = _b;
+        EXPECT_THROW(std::bad_alloc, _t = _src);
+        budget = -1;
+        EXPECT_TRUE(_t.empty());
+        EXPECT_NOTHROW(_t.check());
+    }
+    EXPECT_EQ(live, _held);
+}
+
+int main(void) {
+    {
+        icy::disjoint_set<unsigned, std::hash<unsigned>, budget_allocator<unsigned>> _s {{0, 1}, {2, 3, 4}, {5}};
+        out_of_memory(_s);
+        icy::disjoint_map<unsigned, std::string, std::hash<unsigned>, budget_allocator<unsigned>> _m {
+            {{0, "zero"}, {1, "one"}}, {{2, "two"}}
+        };
+        out_of_memory(_m);
+    }
+    EXPECT_EQ(live, 0);
+    for (unsigned _seed = 0; _seed != 4; ++_seed) {
+        replay<icy::disjoint_set<unsigned>>(_seed);
+        replay<index_set>(_seed);
+    }
+    // same keys, same sizes and same number of classifications, different partitions
+    icy::disjoint_set<unsigned> _x {{0, 1}, {2, 3}};
+    icy::disjoint_set<unsigned> _y {{0, 2}, {1, 3}};
+    EXPECT_NQ(_x, _y);
+    EXPECT_NQ(_y, _x);
+    icy::disjoint_set<unsigned> _z {{3, 2}, {1, 0}};
+    EXPECT_EQ(_x, _z);
+    icy::disjoint_set<unsigned> _w {{0, 1}, {2, 4}};
+    EXPECT_NQ(_x, _w);
+    // a copy keeps the partition however the source trees are shaped
+    icy::disjoint_set<unsigned> _s;
+    for (unsigned _i = 0; _i != 1000; ++_i) EXPECT_TRUE(_s.add(_i));
+    for (unsigned _i = 1; _i != 1000; ++_i) EXPECT_TRUE(_s.merge(_i % 10, _i));
+    EXPECT_TRUE(_s.join(5u));
+    icy::disjoint_set<unsigned> _copy = _s;
+    EXPECT_EQ(_copy, _s);
+    EXPECT_EQ(_copy.classification(), _s.classification());
+    EXPECT_EQ(_copy.sibling(5u), 1);
+    EXPECT_NOTHROW(_copy.check());
+    EXPECT_TRUE(_copy.join(7u, 8u));
+    EXPECT_NQ(_copy, _s);
+    _copy = _s;
+    EXPECT_EQ(_copy, _s);
+    // values take part in the comparison of maps
+    icy::disjoint_map<std::string, std::string> _world {
+        {{"ger", "berlin"}, {"ita", "rome"}}, {{"eng", "london"}}
+    };
+    icy::disjoint_map<std::string, std::string> _other = _world;
+    EXPECT_EQ(_other, _world);
+    EXPECT_TRUE(_other.update("ita", "milan"));
+    EXPECT_NQ(_other, _world);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "main.hpp"
+#include "reference.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <string>
+
+struct dense_index_policy : public icy::dense_policy {
+    using storage_policy = icy::index_storage;
+};
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 4; ++_seed) {
+        replay<icy::dense_disjoint_set<unsigned>>(_seed);
+        replay<icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, dense_index_policy>>(_seed);
+    }
+    icy::dense_disjoint_set<std::uint32_t> _vertices {{0u, 1u, 2u}, {7u}, {100u, 4u}};
+    EXPECT_EQ(_vertices.size(), 6);
+    EXPECT_EQ(_vertices.classification(), 3);
+    EXPECT_FALSE(_vertices.contains(3u));
+    EXPECT_FALSE(_vertices.contains(1000u));
+    EXPECT_FALSE(_vertices.sibling(1000u, 0u));
+    EXPECT_EQ(_vertices.sibling(1000u), 0);
+    EXPECT_TRUE(_vertices.merge(7u, 100u));
+    EXPECT_TRUE(_vertices.join(2u, 4u));
+    EXPECT_EQ(_vertices.sibling(7u), 4);
+    EXPECT_TRUE(_vertices.del(0u));
+    EXPECT_FALSE(_vertices.contains(0u));
+    EXPECT_TRUE(_vertices.add(0u, 1u));
+    EXPECT_TRUE(_vertices.del_all(100u));
+    EXPECT_EQ(_vertices.size(), 2);
+    EXPECT_TRUE(_vertices.sibling(0u, 1u));
+    EXPECT_NOTHROW(_vertices.check());
+    // signed keys are accepted as long as they are not negative
+    icy::dense_disjoint_set<int> _signed {{0, 1}};
+    EXPECT_FALSE(_signed.contains(-1));
+    EXPECT_THROW(std::out_of_range, _signed.add(-1, 0));
+    EXPECT_THROW(std::out_of_range, _signed.add(-1));
+    EXPECT_EQ(_signed.size(), 2);
+
+    icy::dense_disjoint_map<unsigned, std::string> _digit {
+        {{2u, "two"}, {4u, "four"}}, {{1u, "one"}, {3u, "three"}}
+    };
+    _digit[0u] = "zero";
+    EXPECT_TRUE(_digit.merge(0u, 2u));
+    EXPECT_EQ(_digit.sibling(4u), 3);
+    EXPECT_EQ(_digit.at(3u), "three");
+    EXPECT_THROW(std::out_of_range, _digit.at(5u));
+    icy::dense_disjoint_map<unsigned, std::string> _copy = _digit;
+    EXPECT_EQ(_copy, _digit);
+    return 0;
+}
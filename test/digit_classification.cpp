@@ -1,7 +1,9 @@
 #include "main.hpp"
 
 #include "disjoint.hpp"
+#include "disjoint_mapped.hpp"
 
+#include <filesystem>
 #include <string>
 
 int main(void) {
@@ -67,5 +69,22 @@ int main(void) {
     EXPECT_TRUE(_prime.join(6u, 2u));
     EXPECT_TRUE(_prime.join(8u, 3u));
     EXPECT_EQ(_length, _prime);
+    // archive, the values come back with the classifications
+    const auto _path = std::filesystem::temp_directory_path() / "icy_digit_classification.dsj";
+    _prime.save(_path);
+    icy::disjoint_map<unsigned, std::string> _loaded = icy::disjoint_map<unsigned, std::string>::load(_path);
+    EXPECT_EQ(_loaded, _prime);
+    EXPECT_EQ(_loaded.at(9u), "nine");
+    EXPECT_EQ(_loaded.sibling(3u), 3);
+    EXPECT_NOTHROW(_loaded.check());
+    // the keys are trivially copyable, so the file is also queried in place
+    icy::mapped_disjoint_set<unsigned> _mapped(_path);
+    EXPECT_EQ(_mapped.size(), 10);
+    EXPECT_EQ(_mapped.classification(), 3);
+    EXPECT_TRUE(_mapped.sibling(0u, 9u));
+    EXPECT_FALSE(_mapped.sibling(1u, 3u));
+    EXPECT_EQ(_mapped.sibling(4u), 4);
+    EXPECT_FALSE(_mapped.contains(10u));
+    std::filesystem::remove(_path);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief payload counting its copies and moves
+ */
+struct counted {
+    static inline unsigned copies = 0, moves = 0;
+    counted() = default;
+    counted(unsigned _n, unsigned _v) : _features(_n, _v) {}
+    counted(const counted& _rhs) : _features(_rhs._features) { ++copies; }
+    counted(counted&& _rhs) noexcept : _features(std::move(_rhs._features)) { ++moves; }
+    counted& operator=(const counted& _rhs) { _features = _rhs._features; ++copies; return *this; }
+    counted& operator=(counted&& _rhs) noexcept { _features = std::move(_rhs._features); ++moves; return *this; }
+    bool operator==(const counted&) const = default;
+    std::vector<unsigned> _features;
+};
+
+struct pool_policy : public icy::disjoint_policy {
+    using storage_policy = icy::pool_storage;
+};
+struct keyed_index_policy : public icy::disjoint_policy {
+    using storage_policy = icy::index_storage;
+    using key_policy = icy::keyed_nodes;
+};
+template <typename _Policy> using map_type = icy::disjoint_map<std::string, counted, std::hash<std::string>, std::allocator<std::string>, _Policy>;
+
+/// allocations left before `budget_allocator` throws, negative for no limit
+static long budget = -1;
+/**
+ * @brief allocator that throws `std::bad_alloc` once the budget is spent
+ */
+template <typename _Tp> struct budget_allocator {
+    using value_type = _Tp;
+    budget_allocator() = default;
+    template <typename _Up> budget_allocator(const budget_allocator<_Up>&) {}
+    auto allocate(size_t _n) -> _Tp* {
+        if (budget == 0) throw std::bad_alloc();
+        if (budget > 0) --budget;
+        return std::allocator<_Tp>().allocate(_n);
+    }
+    auto deallocate(_Tp* _p, size_t _n) -> void { std::allocator<_Tp>().deallocate(_p, _n); }
+    template <typename _Up> bool operator==(const budget_allocator<_Up>&) const { return true; }
+};
+
+template <typename _Map> void no_copy() {
+    counted::copies = 0; counted::moves = 0;
+    _Map _m;
+    // constructed in place
+    EXPECT_TRUE(_m.try_emplace("ger", 512u, 1u));
+    EXPECT_TRUE(_m.emplace("ita", "ger", 512u, 2u));
+    EXPECT_FALSE(_m.try_emplace("ger", 512u, 3u));
+    EXPECT_FALSE(_m.emplace("jap", "usa", 512u, 3u));
+    EXPECT_EQ(counted::moves, 0);
+    // moved in
+    EXPECT_TRUE(_m.add({"eng", counted(512u, 4u)}));
+    EXPECT_TRUE(_m.add({"fra", counted(512u, 5u)}, "eng"));
+    counted _usa(512u, 6u);
+    EXPECT_TRUE(_m.try_emplace("usa", std::move(_usa)));
+    EXPECT_TRUE(_m.update("ita", counted(512u, 7u)));
+    _m["sov"]._features.assign(512u, 8u);
+    EXPECT_EQ(counted::copies, 0);
+    EXPECT_EQ(_m.at("ita")._features[0], 7u);
+    EXPECT_EQ(_m.sibling("ita"), 2);
+    EXPECT_EQ(_m.sibling("fra"), 2);
+    EXPECT_EQ(_m.size(), 6);
+    EXPECT_NOTHROW(_m.check());
+    // the lvalue overloads still copy once
+    const counted _jap(16u, 9u);
+    EXPECT_TRUE(_m.add({"jap", _jap}, "ger"));
+    const unsigned _copies = counted::copies;
+    EXPECT_TRUE(_m.update("jap", _jap));
+    EXPECT_EQ(counted::copies, _copies + 1);
+}
+
+/**
+ * @brief a key whose node or header cannot be allocated is not added, and nothing is left behind
+ */
+auto out_of_memory() -> void {
+    icy::disjoint_set<unsigned, std::hash<unsigned>, budget_allocator<unsigned>> _s;
+    icy::disjoint_map<unsigned, unsigned, std::hash<unsigned>, budget_allocator<unsigned>> _m;
+    for (unsigned _k = 0; _k != 4; ++_k) {
+        // the node fails, then the header
+        for (long _b : {0, 1}) {
+            budget = _b;
+            EXPECT_THROW(std::bad_alloc, _s.add(_k));
+            budget = _b;
+            EXPECT_THROW(std::bad_alloc, _m.try_emplace(_k, _k));
+            budget = _b;
+            EXPECT_THROW(std::bad_alloc, _m[_k]);
+        }
+        budget = -1;
+        EXPECT_FALSE(_s.contains(_k));
+        EXPECT_FALSE(_m.contains(_k));
+        EXPECT_TRUE(_s.add(_k));
+        EXPECT_TRUE(_m.try_emplace(_k, _k));
+    }
+    EXPECT_EQ(_s.size(), 4);
+    EXPECT_EQ(_m.size(), 4);
+    EXPECT_NOTHROW(_s.check());
+    EXPECT_NOTHROW(_m.check());
+}
+
+int main(void) {
+    out_of_memory();
+    no_copy<map_type<icy::disjoint_policy>>();
+    no_copy<map_type<pool_policy>>();
+    no_copy<map_type<keyed_index_policy>>();
+    return 0;
+}
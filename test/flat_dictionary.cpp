@@ -0,0 +1,61 @@
+#include "main.hpp"
+#include "reference.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstddef>
+#include <string>
+
+struct flat_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+};
+struct flat_index_policy : public flat_policy {
+    using storage_policy = icy::index_storage;
+};
+/**
+ * @brief poor hash, 64 consecutive keys share a home slot, so probes are long and erasure shifts a lot
+ */
+struct clustered_hash {
+    size_t operator()(unsigned _k) const { return _k / 64; }
+};
+
+template <typename _Key, typename _Hash = std::hash<_Key>> using flat_set = icy::disjoint_set<_Key, _Hash, std::allocator<_Key>, flat_policy>;
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 4; ++_seed) {
+        replay<flat_set<unsigned>>(_seed);
+        replay<flat_set<unsigned, clustered_hash>>(_seed);
+        replay<icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, flat_index_policy>>(_seed);
+    }
+    flat_set<std::string> _world {
+        {"chi", "prc", "shx"}, {"jap", "man", "men"}, {"ger"}, {"eng", "can", "raj"}, {"usa", "phi"}
+    };
+    EXPECT_EQ(_world.size(), 12);
+    EXPECT_EQ(_world.classification(), 5);
+    EXPECT_FALSE(_world.contains("ita"));
+    EXPECT_TRUE(_world.add("ita", "ger"));
+    EXPECT_TRUE(_world.merge("usa", "eng"));
+    EXPECT_TRUE(_world.sibling("phi", "raj"));
+    EXPECT_EQ(_world.sibling("can"), 5);
+    EXPECT_TRUE(_world.del_except("ger"));
+    EXPECT_FALSE(_world.contains("ita"));
+    EXPECT_TRUE(_world.del_all("prc"));
+    EXPECT_EQ(_world.size(), 9);
+    EXPECT_NOTHROW(_world.check());
+    // grow far beyond the first table and erase most of it again
+    flat_set<std::string> _many;
+    for (unsigned _i = 0; _i != 10; ++_i) EXPECT_TRUE(_many.add(std::to_string(_i)));
+    for (unsigned _i = 10; _i != 10000; ++_i) EXPECT_TRUE(_many.add(std::to_string(_i), std::to_string(_i % 10)));
+    EXPECT_EQ(_many.size(), 10000);
+    EXPECT_EQ(_many.classification(), 10);
+    EXPECT_TRUE(_many.del_all("3"));
+    EXPECT_TRUE(_many.del_except("7"));
+    EXPECT_EQ(_many.size(), 8001);
+    EXPECT_TRUE(_many.contains("7"));
+    EXPECT_FALSE(_many.contains("17"));
+    EXPECT_TRUE(_many.sibling("18", "9998"));
+    flat_set<std::string> _copy = _many;
+    EXPECT_EQ(_copy, _many);
+    EXPECT_NOTHROW(_many.check());
+    return 0;
+}
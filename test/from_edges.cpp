@@ -0,0 +1,109 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <array>
+#include <list>
+#include <new>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+struct index_policy : public icy::disjoint_policy {
+    using storage_policy = icy::index_storage;
+};
+struct flat_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+};
+/// allocations left before `budget_allocator` throws, negative for no limit
+static long budget = -1;
+/// blocks allocated by `budget_allocator` and not released yet
+static long live = 0;
+/**
+ * @brief allocator that throws `std::bad_alloc` once the budget is spent
+ */
+template <typename _Tp> struct budget_allocator {
+    using value_type = _Tp;
+    budget_allocator() = default;
+    template <typename _Up> budget_allocator(const budget_allocator<_Up>&) {}
+    auto allocate(size_t _n) -> _Tp* {
+        if (budget == 0) throw std::bad_alloc();
+        if (budget > 0) --budget;
+        ++live;
+        return std::allocator<_Tp>().allocate(_n);
+    }
+    auto deallocate(_Tp* _p, size_t _n) -> void { --live; std::allocator<_Tp>().deallocate(_p, _n); }
+    template <typename _Up> bool operator==(const budget_allocator<_Up>&) const { return true; }
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+
+/**
+ * @brief the bulk build agrees with `add` and `merge` one key at a time
+ */
+template <typename _Set> void agree(unsigned _seed, unsigned _threads) {
+    static constexpr unsigned _keys = 5000, _edges = 4000;
+    std::mt19937 _gen(_seed);
+    std::uniform_int_distribution<unsigned> _key(0, _keys + 100);
+    std::vector<unsigned> _k;
+    for (unsigned _i = 0; _i != _keys; ++_i) _k.push_back(_i);
+    _k.push_back(3); // repeated key
+    std::vector<std::pair<unsigned, unsigned>> _e;
+    for (unsigned _i = 0; _i != _edges; ++_i) _e.emplace_back(_key(_gen), _key(_gen));
+    _Set _expected;
+    for (unsigned _i : _k) _expected.add(_i);
+    for (const auto& [_x, _y] : _e) _expected.merge(_x, _y);
+    const _Set _s = _Set::from_edges(_k, _e, _threads);
+    EXPECT_EQ(_s.size(), _keys);
+    EXPECT_EQ(_s.classification(), _expected.classification());
+    EXPECT_EQ(_s, _expected);
+    EXPECT_EQ(_s.height(), 1);
+    EXPECT_NOTHROW(_s.check());
+}
+
+/**
+ * @brief a node that cannot be allocated leaves no header behind
+ */
+void out_of_memory() {
+    using budget_set = icy::disjoint_set<unsigned, std::hash<unsigned>, budget_allocator<unsigned>>;
+    const std::vector<unsigned> _k {0, 1, 2, 3, 4, 5};
+    const std::vector<std::pair<unsigned, unsigned>> _e {{0, 1}, {2, 3}};
+    // 4 headers and 6 nodes
+    for (long _b = 0; _b != 10; ++_b) {
+        budget = _b;
+        EXPECT_THROW(std::bad_alloc, budget_set::from_edges(_k, _e, 1));
+        EXPECT_EQ(live, 0);
+    }
+    budget = -1;
+    EXPECT_EQ(budget_set::from_edges(_k, _e, 1).classification(), 4);
+    EXPECT_EQ(live, 0);
+}
+
+int main(void) {
+    out_of_memory();
+    for (unsigned _seed = 0; _seed != 3; ++_seed) {
+        agree<icy::disjoint_set<unsigned>>(_seed, 1);
+        agree<icy::disjoint_set<unsigned>>(_seed, 4);
+        agree<set_type<index_policy>>(_seed, 3);
+        agree<set_type<flat_policy>>(_seed, 0);
+        agree<icy::dense_disjoint_set<unsigned>>(_seed, 2);
+    }
+    // any pair-like edges, and ranges without random access
+    const std::list<std::string> _countries {"ger", "ita", "jap", "eng", "usa", "sov", "chi"};
+    const std::vector<std::array<std::string, 2>> _axis {{"ger", "ita"}, {"ita", "jap"}};
+    auto _world = icy::disjoint_set<std::string>::from_edges(_countries, _axis);
+    EXPECT_EQ(_world.classification(), 5);
+    EXPECT_TRUE(_world.sibling("ger", "jap"));
+    const std::list<std::tuple<std::string, std::string>> _allies {{"eng", "usa"}, {"usa", "sov"}, {"sov", "chi"}, {"fra", "eng"}};
+    _world = icy::disjoint_set<std::string>::from_edges(_countries, _allies, 4);
+    EXPECT_EQ(_world.classification(), 4);
+    EXPECT_EQ(_world.sibling("chi"), 4);
+    EXPECT_FALSE(_world.contains("fra"));
+    EXPECT_NOTHROW(_world.check());
+    // no edges, no keys
+    const std::vector<std::pair<unsigned, unsigned>> _none;
+    EXPECT_EQ(set_type<index_policy>::from_edges(std::vector<unsigned>{1, 2, 3}, _none, 4).classification(), 3);
+    EXPECT_TRUE(set_type<index_policy>::from_edges(std::vector<unsigned>{}, _none).empty());
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "main.hpp"
+#include "reference.hpp"
+
+#include "disjoint.hpp"
+
+#include <stdexcept>
+#include <string>
+
+struct index_policy : public icy::disjoint_policy {
+    using storage_policy = icy::index_storage;
+};
+template <typename _Key> using index_set = icy::disjoint_set<_Key, std::hash<_Key>, std::allocator<_Key>, index_policy>;
+/**
+ * @brief payload whose construction fails on request
+ */
+struct fragile {
+    explicit fragile(bool _fail) { if (_fail) throw std::runtime_error("fragile"); }
+    unsigned _v = 0;
+};
+template <typename _Key, typename _Value> using index_map = icy::disjoint_map<_Key, _Value, std::hash<_Key>, std::allocator<_Key>, index_policy>;
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 4; ++_seed) {
+        replay<icy::disjoint_set<unsigned>>(_seed);
+        replay<index_set<unsigned>>(_seed);
+    }
+    index_map<unsigned, std::string> _digit {
+        {{2u, "two"}, {4u, "four"}, {6u, "six"}, {8u, "eight"}},
+        {{1u, "first"}, {3u, "three"}, {5u, "five"}, {7u, "seven"}}
+    };
+    _digit[0u] = "zero";
+    EXPECT_TRUE(_digit.merge(1u, 0u));
+    EXPECT_TRUE(_digit.update(1u, "one"));
+    EXPECT_TRUE(_digit.join(0u, 2u));
+    EXPECT_EQ(_digit.at(1u), "one");
+    EXPECT_EQ(_digit.sibling(2u), 5);
+    EXPECT_TRUE(_digit.del_except(5u));
+    EXPECT_EQ(_digit.size(), 6);
+    EXPECT_EQ(_digit.at(5u), "five");
+    EXPECT_NOTHROW(_digit.check());
+    // a slot whose construction fails goes back to the free list
+    icy::slab<fragile, std::allocator<fragile>> _slab;
+    const auto _i = _slab.allocate(false);
+    const auto _j = _slab.allocate(false);
+    _slab.deallocate(_i);
+    EXPECT_THROW(std::runtime_error, _slab.allocate(true));
+    EXPECT_EQ(_slab.allocate(false), _i);
+    EXPECT_THROW(std::runtime_error, _slab.allocate(true));
+    EXPECT_EQ(_slab.allocate(false), _j + 1);
+    EXPECT_EQ(_slab.size(), 3);
+    index_map<unsigned, fragile> _values;
+    EXPECT_TRUE(_values.try_emplace(1u, false));
+    EXPECT_THROW(std::runtime_error, _values.try_emplace(2u, true));
+    EXPECT_FALSE(_values.contains(2u));
+    EXPECT_TRUE(_values.try_emplace(2u, false));
+    EXPECT_EQ(_values.size(), 2);
+    EXPECT_NOTHROW(_values.check());
+    return 0;
+}
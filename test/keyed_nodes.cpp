@@ -0,0 +1,81 @@
+#include "main.hpp"
+#include "reference.hpp"
+
+#include "disjoint.hpp"
+
+#include <string>
+
+struct keyed_policy : public icy::disjoint_policy {
+    using key_policy = icy::keyed_nodes;
+};
+struct keyed_dense_policy : public icy::dense_policy {
+    using key_policy = icy::keyed_nodes;
+};
+struct keyed_flat_index_policy : public keyed_policy {
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+};
+struct keyed_pool_policy : public keyed_policy {
+    using storage_policy = icy::pool_storage;
+};
+template <typename _Key, typename _Policy> using set_type = icy::disjoint_set<_Key, std::hash<_Key>, std::allocator<_Key>, _Policy>;
+template <typename _Key, typename _Value, typename _Policy> using map_type = icy::disjoint_map<_Key, _Value, std::hash<_Key>, std::allocator<_Key>, _Policy>;
+
+/**
+ * @brief `del_all` and `del_except` on one small classification leave the others untouched
+ */
+template <typename _Set> void small_classes() {
+    static constexpr unsigned _n = 1000;
+    _Set _s;
+    for (unsigned _i = 0; _i != _n; ++_i) EXPECT_TRUE(_s.add(_i));
+    for (unsigned _i = 0; _i != _n; _i += 4) {
+        EXPECT_TRUE(_s.merge(_i, _i + 1));
+        EXPECT_TRUE(_s.merge(_i + 2, _i + 3));
+        EXPECT_TRUE(_s.merge(_i + 1, _i + 3));
+    }
+    EXPECT_EQ(_s.classification(), _n / 4);
+    EXPECT_TRUE(_s.del_all(6u));
+    EXPECT_FALSE(_s.contains(4u));
+    EXPECT_FALSE(_s.contains(7u));
+    EXPECT_TRUE(_s.del_except(9u));
+    EXPECT_EQ(_s.sibling(9u), 1);
+    EXPECT_FALSE(_s.contains(8u));
+    EXPECT_EQ(_s.size(), _n - 7);
+    EXPECT_EQ(_s.classification(), _n / 4 - 1);
+    EXPECT_EQ(_s.sibling(12u), 4);
+    EXPECT_NOTHROW(_s.check());
+}
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 4; ++_seed) {
+        replay<set_type<unsigned, keyed_policy>>(_seed);
+        replay<set_type<unsigned, keyed_dense_policy>>(_seed);
+        replay<set_type<unsigned, keyed_flat_index_policy>>(_seed);
+        replay<set_type<unsigned, keyed_pool_policy>>(_seed);
+    }
+    small_classes<set_type<unsigned, keyed_policy>>();
+    small_classes<set_type<unsigned, keyed_dense_policy>>();
+    small_classes<set_type<unsigned, keyed_flat_index_policy>>();
+    // keys with destructors, the handle of a hash dictionary is the address of the key
+    map_type<std::string, std::string, keyed_policy> _world {
+        {{"ger", "berlin"}, {"ita", "rome"}, {"jap", "tokyo"}},
+        {{"eng", "london"}, {"usa", "washington, d.c."}, {"fra", "paris"}}
+    };
+    for (unsigned _i = 0; _i != 1000; ++_i) {
+        EXPECT_TRUE(_world.add({std::to_string(_i), "neutral"}));
+    }
+    EXPECT_NOTHROW(_world.check());
+    EXPECT_TRUE(_world.del_except("ita"));
+    EXPECT_EQ(_world.sibling("ita"), 1);
+    EXPECT_FALSE(_world.contains("ger"));
+    EXPECT_TRUE(_world.del_all("usa"));
+    EXPECT_FALSE(_world.contains("fra"));
+    EXPECT_EQ(_world.size(), 1001);
+    EXPECT_EQ(_world.at("ita"), "rome");
+    EXPECT_NOTHROW(_world.check());
+    map_type<std::string, std::string, keyed_policy> _copy = _world;
+    EXPECT_EQ(_copy, _world);
+    EXPECT_TRUE(_copy.del_all("42"));
+    EXPECT_NOTHROW(_copy.check());
+    return 0;
+}
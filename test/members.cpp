@@ -0,0 +1,88 @@
+#include "main.hpp"
+#include "reference.hpp"
+
+#include "disjoint.hpp"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <ranges>
+#include <set>
+#include <string>
+#include <vector>
+
+struct keyed_policy : public icy::disjoint_policy {
+    using key_policy = icy::keyed_nodes;
+};
+struct keyed_flat_index_policy : public keyed_policy {
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+using map_type = icy::disjoint_map<std::string, unsigned, std::hash<std::string>, std::allocator<std::string>, keyed_policy>;
+
+static_assert(std::ranges::forward_range<set_type<keyed_policy>::member_range>);
+static_assert(std::ranges::sized_range<set_type<keyed_policy>::member_range>);
+static_assert(std::ranges::common_range<set_type<keyed_policy>::class_range>);
+static_assert(std::ranges::forward_range<set_type<keyed_policy>::class_range>);
+static_assert(std::ranges::forward_range<map_type::member_range>);
+
+/**
+ * @brief shuffle the trees with random merges and joins, then compare the enumeration with the naive partition
+ */
+template <typename _Set> void enumerate(unsigned _seed) {
+    static constexpr unsigned _keys = 512;
+    std::mt19937 _gen(_seed);
+    std::uniform_int_distribution<unsigned> _key(0, _keys - 1), _op(0, 9);
+    _Set _s; reference _r;
+    for (unsigned _k = 0; _k != _keys; ++_k) { _s.add(_k); _r.add(_k); }
+    for (unsigned _step = 0; _step != 4000; ++_step) {
+        const unsigned _x = _key(_gen), _y = _key(_gen), _o = _op(_gen);
+        if (_o < 6) { EXPECT_EQ(_s.merge(_x, _y), _r.merge(_x, _y)); }
+        else if (_o < 8) { EXPECT_EQ(_s.join(_x, _y), _r.join(_x, _y)); }
+        else if (_o < 9) { EXPECT_EQ(_s.join(_x), _r.join(_x)); }
+        else { EXPECT_EQ(_s.del(_x), _r.del(_x)); EXPECT_EQ(_s.add(_x, _y), _r.add(_x, _y)); }
+        if (_step % 128 != 0) continue;
+        for (unsigned _k = 0; _k != _keys; ++_k) {
+            std::vector<unsigned> _got(_s.members(_k).begin(), _s.members(_k).end());
+            EXPECT_EQ(_got.size(), _r.sibling(_k));
+            EXPECT_EQ(_s.members(_k).size(), _r.sibling(_k));
+            for (unsigned _m : _got) EXPECT_TRUE(_r.sibling(_k, _m));
+            EXPECT_EQ(std::set<unsigned>(_got.begin(), _got.end()).size(), _got.size());
+        }
+        size_t _total = 0, _classes = 0;
+        for (auto _class : _s.classes()) {
+            const unsigned _first = *_class.begin();
+            for (unsigned _m : _class) EXPECT_TRUE(_r.sibling(_first, _m));
+            EXPECT_EQ(static_cast<size_t>(std::ranges::distance(_class)), _class.size());
+            _total += _class.size(); ++_classes;
+        }
+        EXPECT_EQ(_total, _r._label.size());
+        EXPECT_EQ(_classes, _r.classification());
+        EXPECT_NOTHROW(_s.check());
+    }
+}
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 4; ++_seed) {
+        enumerate<set_type<keyed_policy>>(_seed);
+        enumerate<set_type<keyed_flat_index_policy>>(_seed);
+    }
+    set_type<keyed_policy> _empty;
+    EXPECT_TRUE(_empty.members(1u).empty());
+    EXPECT_TRUE(_empty.classes().empty());
+    // members of a map read as key-value pairs
+    map_type _world {
+        {{"ger", 1939}, {"ita", 1940}, {"jap", 1941}},
+        {{"eng", 1939}, {"fra", 1939}}
+    };
+    EXPECT_TRUE(_world.join("jap"));
+    std::map<std::string, unsigned> _axis;
+    for (const auto& [_k, _v] : _world.members("ger")) _axis.emplace(_k, _v);
+    EXPECT_EQ(_axis, (std::map<std::string, unsigned> {{"ger", 1939}, {"ita", 1940}}));
+    EXPECT_EQ(_world.classes().size(), 3);
+    auto _keys = _world.members("eng") | std::views::keys;
+    EXPECT_EQ(std::ranges::count(_keys, std::string("fra")), 1);
+    EXPECT_TRUE(_world.members("usa").empty());
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+struct ordered_policy : public icy::disjoint_policy {
+    using merge_policy = icy::merge_by_order;
+};
+struct flat_node_policy : public icy::disjoint_policy {
+    using compress_policy = icy::compress_node;
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+};
+struct keyed_dense_policy : public icy::dense_policy {
+    using storage_policy = icy::pool_storage;
+    using key_policy = icy::keyed_nodes;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+
+/**
+ * @brief `merge_batch` leaves the same classifications as a sequence of `merge`, on a hub heavy stream
+ */
+template <typename _Set> void agree(unsigned _seed) {
+    static constexpr unsigned _n = 3000;
+    std::mt19937 _gen(_seed);
+    std::uniform_int_distribution<unsigned> _key(0, _n + _n / 8);
+    std::uniform_int_distribution<unsigned> _hub(0, 3);
+    _Set _batched, _sequential;
+    for (unsigned _i = 0; _i != _n; ++_i) {
+        _batched.add(_i);
+        _sequential.add(_i);
+    }
+    for (unsigned _round = 0; _round != 3; ++_round) {
+        std::vector<std::pair<unsigned, unsigned>> _pairs(_n / 2);
+        for (auto& _p : _pairs) _p = {_hub(_gen) == 0 ? 0 : _key(_gen), _key(_gen)};
+        _pairs.emplace_back(1, 1);
+        _pairs.emplace_back(_n + 1, 2);
+        const size_t _before = _sequential.classification();
+        for (const auto& [_x, _y] : _pairs) _sequential.merge(_x, _y);
+        EXPECT_EQ(_batched.merge_batch(_pairs), _before - _sequential.classification());
+        EXPECT_EQ(_batched.classification(), _sequential.classification());
+        EXPECT_EQ(_batched, _sequential);
+        EXPECT_NOTHROW(_batched.check());
+    }
+    EXPECT_EQ(_batched.merge_batch(std::vector<std::pair<unsigned, unsigned>> {}), 0);
+    EXPECT_EQ(_batched.merge_batch(std::vector<std::pair<unsigned, unsigned>> {{0, 1}}), 0);
+}
+
+/**
+ * @brief the root of a group is chosen as a sequence of `merge` would choose it
+ */
+void root_choice() {
+    set_type<ordered_policy> _s;
+    for (unsigned _i = 0; _i != 6; ++_i) _s.add(_i);
+    std::vector<set_type<ordered_policy>::class_id> _ids;
+    _s.find_batch(std::vector<unsigned> {5}, std::back_inserter(_ids));
+    EXPECT_EQ(_s.merge_batch(std::vector<std::pair<unsigned, unsigned>> {{3, 4}, {5, 3}, {0, 1}}), 3);
+    // the class of 5 absorbed the class of 3 last, so the header of 5 is the root
+    _s.find_batch(std::vector<unsigned> {3, 4, 5}, std::back_inserter(_ids));
+    EXPECT_EQ(_ids[0], _ids[1]);
+    EXPECT_EQ(_ids[0], _ids[2]);
+    EXPECT_EQ(_ids[0], _ids[3]);
+    set_type<ordered_policy> _t;
+    for (unsigned _i = 0; _i != 6; ++_i) _t.add(_i);
+    _t.merge(3, 4);
+    _t.merge(5, 3);
+    _t.merge(0, 1);
+    EXPECT_EQ(_s, _t);
+    EXPECT_NOTHROW(_s.check());
+}
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 4; ++_seed) {
+        agree<icy::disjoint_set<unsigned>>(_seed);
+        agree<set_type<ordered_policy>>(_seed);
+        agree<set_type<flat_node_policy>>(_seed);
+        agree<set_type<keyed_dense_policy>>(_seed);
+    }
+    root_choice();
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstddef>
+
+struct order_policy : public icy::disjoint_policy {
+    using merge_policy = icy::merge_by_order;
+};
+
+static constexpr std::size_t _n = 1ul << 12;
+static constexpr std::size_t _log_n = 12ul;
+
+template <typename _Set> void chain(_Set& _s) {
+    for (unsigned _i = 0; _i != _n; ++_i) {
+        EXPECT_TRUE(_s.add(_i));
+    }
+    // the new singleton always comes first, so `merge_by_order` hangs the whole chain under it
+    for (unsigned _i = 1; _i != _n; ++_i) {
+        EXPECT_TRUE(_s.merge(_i, _i - 1));
+    }
+    EXPECT_EQ(_s.size(), _n);
+    EXPECT_EQ(_s.classification(), 1);
+    EXPECT_EQ(_s.sibling(_n - 1), _n);
+}
+template <typename _Set> void binomial(_Set& _s) {
+    for (unsigned _i = 0; _i != _n; ++_i) {
+        EXPECT_TRUE(_s.add(_i));
+    }
+    // merge classifications of equal size, the worst case of union by size
+    for (unsigned _step = 1; _step != _n; _step <<= 1) {
+        for (unsigned _i = 0; _i + _step < _n; _i += (_step << 1)) {
+            EXPECT_TRUE(_s.merge(_i + _step, _i));
+        }
+    }
+    EXPECT_EQ(_s.classification(), 1);
+    EXPECT_EQ(_s.sibling(_n - 1), _n);
+}
+
+int main(void) {
+    icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, order_policy> _ordered;
+    chain(_ordered);
+    EXPECT_EQ(_ordered.height(), _n);
+    EXPECT_NOTHROW(_ordered.check());
+
+    icy::disjoint_set<unsigned> _chain;
+    chain(_chain);
+    EXPECT_LE(_chain.height(), 2);
+    EXPECT_NOTHROW(_chain.check());
+
+    icy::disjoint_set<unsigned> _binomial;
+    binomial(_binomial);
+    EXPECT_LE(_binomial.height(), _log_n + 1);
+    EXPECT_NOTHROW(_binomial.check());
+
+    icy::disjoint_map<unsigned, unsigned> _map;
+    for (unsigned _i = 0; _i != _n; ++_i) {
+        EXPECT_TRUE(_map.add({_i, _i}));
+    }
+    for (unsigned _i = 1; _i != _n; ++_i) {
+        EXPECT_TRUE(_map.merge(_i, _i - 1));
+    }
+    EXPECT_LE(_map.height(), 2);
+    EXPECT_EQ(_map.at(_n - 1), _n - 1);
+    EXPECT_NOTHROW(_map.check());
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct pool_policy : public icy::disjoint_policy {
+    using storage_policy = icy::pool_storage;
+};
+struct keyed_flat_index_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+    using key_policy = icy::keyed_nodes;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+using pool_map = icy::disjoint_map<std::string, std::string, std::hash<std::string>, std::allocator<std::string>, pool_policy>;
+
+static_assert(std::is_nothrow_move_constructible_v<icy::disjoint_set<unsigned>>);
+static_assert(std::is_nothrow_move_assignable_v<icy::disjoint_set<unsigned>>);
+static_assert(std::is_nothrow_move_constructible_v<pool_map>);
+static_assert(std::is_nothrow_swappable_v<set_type<keyed_flat_index_policy>>);
+
+template <typename _Set> auto make(unsigned _n) -> _Set {
+    _Set _s;
+    for (unsigned _i = 0; _i != _n; ++_i) _s.add(_i);
+    for (unsigned _i = 1; _i != _n; ++_i) _s.merge(_i % 3, _i);
+    return _s;
+}
+
+template <typename _Set> void steal() {
+    _Set _s = make<_Set>(100);
+    const _Set _copy = _s;
+    _Set _t = std::move(_s);
+    EXPECT_EQ(_t, _copy);
+    EXPECT_TRUE(_s.empty());
+    EXPECT_EQ(_s.classification(), 0);
+    EXPECT_NOTHROW(_s.check());
+    // the moved-from set is usable again
+    EXPECT_TRUE(_s.add(7u));
+    EXPECT_TRUE(_s.add(8u, 7u));
+    EXPECT_EQ(_s.sibling(8u), 2);
+    _t = std::move(_s);
+    EXPECT_EQ(_t.size(), 2);
+    EXPECT_TRUE(_s.empty());
+    _s = make<_Set>(10);
+    swap(_s, _t);
+    EXPECT_EQ(_s.size(), 2);
+    EXPECT_EQ(_t.size(), 10);
+    EXPECT_EQ(_t.classification(), 3);
+    EXPECT_NOTHROW(_s.check());
+    EXPECT_NOTHROW(_t.check());
+    // growing a vector moves the sets instead of copying them
+    std::vector<_Set> _sets;
+    for (unsigned _i = 1; _i != 40; ++_i) _sets.push_back(make<_Set>(_i));
+    for (unsigned _i = 1; _i != 40; ++_i) {
+        EXPECT_EQ(_sets[_i - 1].size(), _i);
+        EXPECT_NOTHROW(_sets[_i - 1].check());
+    }
+}
+
+int main(void) {
+    steal<icy::disjoint_set<unsigned>>();
+    steal<set_type<pool_policy>>();
+    steal<set_type<keyed_flat_index_policy>>();
+    steal<icy::dense_disjoint_set<unsigned>>();
+    set_type<keyed_flat_index_policy> _keyed = make<set_type<keyed_flat_index_policy>>(30);
+    set_type<keyed_flat_index_policy> _other(std::move(_keyed));
+    EXPECT_EQ(_other.members(4u).size(), 10);
+    EXPECT_TRUE(_other.del_all(4u));
+    EXPECT_EQ(_other.size(), 20);
+    pool_map _world {{{"ger", "berlin"}, {"ita", "rome"}}, {{"eng", "london"}}};
+    pool_map _moved = std::move(_world);
+    EXPECT_EQ(_moved.at("ita"), "rome");
+    EXPECT_TRUE(_world.empty());
+    _world.swap(_moved);
+    EXPECT_EQ(_world.sibling("ger"), 2);
+    EXPECT_TRUE(_moved.empty());
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+template <typename _Tp> using pointer_node = icy::node<_Tp, icy::pointer_storage>;
+template <typename _Tp> using pointer_header = icy::header<_Tp, icy::pointer_storage>;
+template <typename _Tp> using index_node = icy::node<_Tp, icy::index_storage>;
+template <typename _Tp> using index_header = icy::header<_Tp, icy::index_storage>;
+
+// a set-only node holds three links and nothing else
+static_assert(!std::is_polymorphic_v<pointer_node<void>>);
+static_assert(std::is_empty_v<icy::storage<void>>);
+static_assert(sizeof(pointer_node<void>) <= 3 * sizeof(void*));
+// the payload is stored in place, without a vptr in front of it
+static_assert(!std::is_polymorphic_v<pointer_node<std::uint32_t>>);
+static_assert(sizeof(pointer_node<std::uint32_t>) <= 4 * sizeof(void*));
+static_assert(sizeof(pointer_node<std::string>) <= 3 * sizeof(void*) + sizeof(std::string));
+static_assert(!std::is_polymorphic_v<pointer_header<void>>);
+// 32-bit handles halve the links
+static_assert(sizeof(index_node<void>) == 3 * sizeof(std::uint32_t));
+static_assert(sizeof(index_node<std::uint32_t>) == 4 * sizeof(std::uint32_t));
+static_assert(sizeof(index_header<void>) == 8 * sizeof(std::uint32_t));
+static_assert(2 * sizeof(index_header<void>) <= sizeof(pointer_header<void>));
+
+int main(void) {
+    icy::disjoint_set<std::uint32_t> _set {{1u, 2u, 3u}, {4u}};
+    EXPECT_EQ(_set.size(), 4);
+    EXPECT_TRUE(_set.del(2u));
+    EXPECT_TRUE(_set.join(3u, 4u));
+    EXPECT_EQ(_set.sibling(4u), 2);
+    EXPECT_NOTHROW(_set.check());
+    icy::disjoint_map<std::uint32_t, std::string> _map {{{1u, "one"}, {2u, "two"}}};
+    EXPECT_TRUE(_map.del(1u));
+    EXPECT_EQ(_map.at(2u), "two");
+    EXPECT_NOTHROW(_map.check());
+    return 0;
+}
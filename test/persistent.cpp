@@ -0,0 +1,83 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static constexpr unsigned _n = 64;
+
+/**
+ * @brief a random modification applied to both containers
+ */
+template <typename _Set, typename _Gen> void mutate(_Set& _s, icy::disjoint_set<unsigned>& _plain, _Gen& _gen) {
+    std::uniform_int_distribution<unsigned> _key(0, _n - 1);
+    const unsigned _x = _key(_gen), _y = _key(_gen);
+    switch (_gen() % 6) {
+    case 0: EXPECT_EQ(_s.add(_x), _plain.add(_x)); break;
+    case 1: EXPECT_EQ(_s.add(_x, _y), _plain.add(_x, _y)); break;
+    case 2: EXPECT_EQ(_s.del(_x), _plain.del(_x)); break;
+    case 3: EXPECT_EQ(_s.join(_x), _plain.join(_x)); break;
+    case 4: EXPECT_EQ(_s.join(_x, _y), _plain.join(_x, _y)); break;
+    default: EXPECT_EQ(_s.merge(_x, _y), _plain.merge(_x, _y)); break;
+    }
+}
+
+/**
+ * @brief compare a version with a full copy taken at the same time
+ */
+template <typename _View> void expect_same(const _View& _v, const icy::disjoint_set<unsigned>& _plain) {
+    EXPECT_EQ(_v.size(), _plain.size());
+    EXPECT_EQ(_v.classification(), _plain.classification());
+    for (unsigned _x = 0; _x != _n; ++_x) {
+        EXPECT_EQ(_v.contains(_x), _plain.contains(_x));
+        EXPECT_EQ(_v.sibling(_x), _plain.sibling(_x));
+        for (unsigned _y = 0; _y != _n; ++_y) {
+            EXPECT_EQ(_v.sibling(_x, _y), _plain.sibling(_x, _y));
+        }
+    }
+}
+
+int main(void) {
+    icy::persistent_disjoint_set<unsigned> _s;
+    icy::disjoint_set<unsigned> _plain;
+    std::vector<icy::disjoint_set<unsigned>> _copies;
+    std::mt19937 _gen(_n);
+    for (unsigned _round = 0; _round != 200; ++_round) {
+        for (unsigned _i = 0; _i != 20; ++_i) mutate(_s, _plain, _gen);
+        EXPECT_EQ(_s.snapshot().version(), _round);
+        _copies.push_back(_plain);
+    }
+    EXPECT_EQ(_s.version(), 200);
+    for (unsigned _i = 0; _i != 20; ++_i) mutate(_s, _plain, _gen);
+    // every past version reads as its copy, the latest one as the current state
+    for (unsigned _v = 0; _v != _copies.size(); ++_v) expect_same(_s.at(_v), _copies[_v]);
+    expect_same(_s.at(_s.version()), _plain);
+    expect_same(_s, _plain);
+    EXPECT_THROW(std::out_of_range, _s.at(_s.version() + 1));
+
+    // the point-in-time query of the backlog: together as of one version, apart later
+    icy::persistent_disjoint_set<std::string> _t {{"a", "b"}, {"c"}};
+    const auto _v0 = _t.snapshot();
+    EXPECT_TRUE(_t.merge("b", "c"));
+    const auto _v1 = _t.snapshot();
+    EXPECT_TRUE(_t.join("b"));
+    EXPECT_TRUE(_t.del("a"));
+    EXPECT_TRUE(_v0.sibling("a", "b"));
+    EXPECT_FALSE(_v0.sibling("a", "c"));
+    EXPECT_TRUE(_v1.sibling("a", "c"));
+    EXPECT_EQ(_v1.sibling("b"), 3);
+    EXPECT_FALSE(_t.contains("a"));
+    EXPECT_TRUE(_v1.contains("a"));
+    EXPECT_EQ(_t.sibling("b"), 1);
+    EXPECT_EQ(_t.sibling("c"), 1);
+    EXPECT_EQ(_t.classification(), 2);
+    EXPECT_EQ(_v1.classification(), 1);
+    // a key deleted then added back is a new member, the old versions keep the old one
+    EXPECT_TRUE(_t.add("a", "c"));
+    EXPECT_TRUE(_t.sibling("a", "c"));
+    EXPECT_FALSE(_v0.sibling("a", "c"));
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "main.hpp"
+#include "reference.hpp"
+
+#include "disjoint.hpp"
+
+#include <string>
+
+struct pool_policy : public icy::disjoint_policy {
+    using storage_policy = icy::pool_storage;
+};
+template <typename _Key> using pool_set = icy::disjoint_set<_Key, std::hash<_Key>, std::allocator<_Key>, pool_policy>;
+template <typename _Key, typename _Value> using pool_map = icy::disjoint_map<_Key, _Value, std::hash<_Key>, std::allocator<_Key>, pool_policy>;
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 4; ++_seed) {
+        replay<pool_set<unsigned>>(_seed);
+    }
+    // values with destructors, released in bulk by `clear` and by the destructor
+    pool_map<std::string, std::string> _world {
+        {{"ger", "berlin"}, {"ita", "rome"}}, {{"eng", "london"}, {"usa", "washington, d.c."}}
+    };
+    EXPECT_TRUE(_world.add({"fra", "paris"}, "eng"));
+    EXPECT_TRUE(_world.join("ita", "eng"));
+    EXPECT_EQ(_world.sibling("usa"), 4);
+    _world.clear();
+    EXPECT_TRUE(_world.empty());
+    EXPECT_EQ(_world.classification(), 0);
+    EXPECT_NOTHROW(_world.check());
+    // the pools are usable again after `clear`, and slots freed by `del` are reused
+    for (unsigned _i = 0; _i != 10000; ++_i) {
+        EXPECT_TRUE(_world.add({std::to_string(_i), std::string(32, 'x')}));
+    }
+    for (unsigned _i = 0; _i != 10000; _i += 2) {
+        EXPECT_TRUE(_world.del(std::to_string(_i)));
+        EXPECT_TRUE(_world.merge(std::to_string(_i + 1), "1"));
+    }
+    for (unsigned _i = 0; _i != 10000; _i += 2) {
+        EXPECT_TRUE(_world.add({std::to_string(_i), "even"}, "1"));
+    }
+    EXPECT_EQ(_world.size(), 10000);
+    EXPECT_EQ(_world.classification(), 1);
+    EXPECT_EQ(_world.at("42"), "even");
+    EXPECT_NOTHROW(_world.check());
+    pool_map<std::string, std::string> _copy = _world;
+    EXPECT_EQ(_copy, _world);
+    // the header of a deleted key is the next one handed out, no new slot is taken
+    pool_set<unsigned> _s {{1u}, {2u}};
+    for (unsigned _i = 3; _i != 1000; ++_i) {
+        const auto _id = _s.find(_i - 1);
+        EXPECT_TRUE(_s.del(_i - 1));
+        EXPECT_TRUE(_s.add(_i));
+        EXPECT_EQ(_s.find(_i), _id);
+    }
+    EXPECT_EQ(_s.classification(), 2);
+    return 0;
+}
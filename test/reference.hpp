@@ -0,0 +1,97 @@
+#pragma once
+
+#include "main.hpp"
+
+#include <cstddef>
+#include <random>
+#include <unordered_map>
+
+/**
+ * @brief naive partition, key -> label of its classification
+ */
+struct reference {
+    std::unordered_map<unsigned, unsigned> _label;
+    unsigned _next = 0;
+    bool add(unsigned _k) { return _label.emplace(_k, _next++).second; }
+    bool add(unsigned _k, unsigned _t) {
+        if (_label.contains(_k) || !_label.contains(_t)) return false;
+        _label[_k] = _label[_t]; return true;
+    }
+    bool del(unsigned _k) { return _label.erase(_k) != 0; }
+    bool del_all(unsigned _k) {
+        if (!_label.contains(_k)) return false;
+        const unsigned _l = _label[_k];
+        std::erase_if(_label, [_l](const auto& _i) { return _i.second == _l; });
+        return true;
+    }
+    bool del_except(unsigned _k) {
+        if (!_label.contains(_k)) return false;
+        const unsigned _l = _label[_k];
+        std::erase_if(_label, [_l, _k](const auto& _i) { return _i.second == _l && _i.first != _k; });
+        return true;
+    }
+    bool join(unsigned _k) {
+        if (!_label.contains(_k)) return false;
+        _label[_k] = _next++; return true;
+    }
+    bool join(unsigned _k, unsigned _t) {
+        if (!_label.contains(_k) || !_label.contains(_t)) return false;
+        _label[_k] = _label[_t]; return true;
+    }
+    bool merge(unsigned _x, unsigned _y) {
+        if (!_label.contains(_x) || !_label.contains(_y)) return false;
+        const unsigned _from = _label[_y], _to = _label[_x];
+        for (auto& [_k, _l] : _label) if (_l == _from) _l = _to;
+        return true;
+    }
+    size_t sibling(unsigned _k) const {
+        if (!_label.contains(_k)) return 0;
+        const unsigned _l = _label.at(_k);
+        size_t _count = 0;
+        for (const auto& _i : _label) _count += (_i.second == _l);
+        return _count;
+    }
+    bool sibling(unsigned _x, unsigned _y) const {
+        return _label.contains(_x) && _label.contains(_y) && _label.at(_x) == _label.at(_y);
+    }
+    size_t classification() const {
+        std::unordered_map<unsigned, bool> _labels;
+        for (const auto& _i : _label) _labels[_i.second] = true;
+        return _labels.size();
+    }
+};
+
+/**
+ * @brief replay a random stream of operations on `_Set` and on the naive partition, and compare them
+ */
+template <typename _Set> void replay(unsigned _seed) {
+    static constexpr unsigned _keys = 256;
+    std::mt19937 _gen(_seed);
+    std::uniform_int_distribution<unsigned> _key(0, _keys - 1), _op(0, 99);
+    _Set _s; reference _r;
+    for (unsigned _step = 0; _step != 20000; ++_step) {
+        const unsigned _x = _key(_gen), _y = _key(_gen), _o = _op(_gen);
+        if (_o < 25) { EXPECT_EQ(_s.add(_x), _r.add(_x)); }
+        else if (_o < 40) { EXPECT_EQ(_s.add(_x, _y), _r.add(_x, _y)); }
+        else if (_o < 65) { EXPECT_EQ(_s.merge(_x, _y), _r.merge(_x, _y)); }
+        else if (_o < 75) { EXPECT_EQ(_s.join(_x, _y), _r.join(_x, _y)); }
+        else if (_o < 82) { EXPECT_EQ(_s.join(_x), _r.join(_x)); }
+        else if (_o < 94) { EXPECT_EQ(_s.del(_x), _r.del(_x)); }
+        else if (_o < 97) { EXPECT_EQ(_s.del_except(_x), _r.del_except(_x)); }
+        else if (_o < 98) { EXPECT_EQ(_s.del_all(_x), _r.del_all(_x)); }
+        else { EXPECT_EQ(_s.sibling(_x), _r.sibling(_x)); }
+        EXPECT_EQ(_s.sibling(_x, _y), _r.sibling(_x, _y));
+        if (_step % 64 == 0) {
+            EXPECT_EQ(_s.size(), _r._label.size());
+            EXPECT_EQ(_s.classification(), _r.classification());
+            EXPECT_NOTHROW(_s.check());
+        }
+    }
+    for (unsigned _k = 0; _k != _keys; ++_k) {
+        EXPECT_EQ(_s.contains(_k), _r._label.contains(_k));
+        EXPECT_EQ(_s.sibling(_k), _r.sibling(_k));
+    }
+    _Set _copy = _s;
+    EXPECT_EQ(_copy, _s);
+    EXPECT_NOTHROW(_copy.check());
+}
@@ -0,0 +1,65 @@
+#include "main.hpp"
+#include "reference.hpp"
+
+#include "disjoint.hpp"
+
+#include <string>
+
+struct pool_policy : public icy::disjoint_policy {
+    using storage_policy = icy::pool_storage;
+};
+struct flat_index_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+};
+struct dense_pool_policy : public icy::dense_policy {
+    using storage_policy = icy::pool_storage;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+
+/**
+ * @brief reserve, load, drop most classes, shrink, and keep using the set
+ */
+template <typename _Set> void reload() {
+    static constexpr unsigned _n = 20000, _classes = 100;
+    _Set _s;
+    _s.reserve(_n, _classes);
+    for (unsigned _i = 0; _i != _classes; ++_i) EXPECT_TRUE(_s.add(_i));
+    for (unsigned _i = _classes; _i != _n; ++_i) EXPECT_TRUE(_s.add(_i, _i % _classes));
+    EXPECT_EQ(_s.size(), _n);
+    EXPECT_EQ(_s.classification(), _classes);
+    for (unsigned _i = 1; _i != _classes; ++_i) EXPECT_TRUE(_s.del_all(_i));
+    EXPECT_EQ(_s.size(), _n / _classes);
+    _s.shrink_to_fit();
+    EXPECT_NOTHROW(_s.check());
+    EXPECT_EQ(_s.sibling(_n - _classes), _n / _classes);
+    EXPECT_TRUE(_s.add(1u, 0u));
+    EXPECT_TRUE(_s.join(1u));
+    EXPECT_EQ(_s.classification(), 2);
+    // nothing alive, everything can be returned
+    EXPECT_TRUE(_s.del_all(0u));
+    EXPECT_TRUE(_s.del_all(1u));
+    _s.shrink_to_fit();
+    EXPECT_TRUE(_s.empty());
+    EXPECT_TRUE(_s.add(7u));
+    EXPECT_NOTHROW(_s.check());
+}
+
+int main(void) {
+    reload<icy::disjoint_set<unsigned>>();
+    reload<set_type<pool_policy>>();
+    reload<set_type<flat_index_policy>>();
+    reload<set_type<dense_pool_policy>>();
+    for (unsigned _seed = 0; _seed != 2; ++_seed) {
+        replay<set_type<pool_policy>>(_seed);
+        replay<set_type<flat_index_policy>>(_seed);
+    }
+    icy::disjoint_map<std::string, std::string> _world;
+    _world.reserve(1000);
+    EXPECT_TRUE(_world.add({"ger", "berlin"}));
+    EXPECT_TRUE(_world.add({"ita", "rome"}, "ger"));
+    _world.shrink_to_fit();
+    EXPECT_EQ(_world.at("ita"), "rome");
+    EXPECT_NOTHROW(_world.check());
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct pointer_policy : public icy::disjoint_policy {
+    using compress_policy = icy::compress_none;
+};
+struct index_policy : public icy::disjoint_policy {
+    using merge_policy = icy::merge_by_order;
+    using compress_policy = icy::compress_none;
+    using storage_policy = icy::index_storage;
+    using dictionary_policy = icy::flat_dictionary;
+};
+struct pool_policy : public icy::disjoint_policy {
+    using compress_policy = icy::compress_none;
+    using storage_policy = icy::pool_storage;
+    using dictionary_policy = icy::dense_dictionary;
+    using key_policy = icy::keyed_nodes;
+};
+template <typename _Policy> using set_type = icy::disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+using map_type = icy::disjoint_map<unsigned, std::string, std::hash<unsigned>, std::allocator<unsigned>, pointer_policy>;
+
+static_assert(set_type<pointer_policy>::reversible);
+static_assert(!icy::disjoint_set<unsigned>::reversible);
+
+static constexpr unsigned _n = 256;
+
+/// allocations left before `budget_allocator` throws, negative for no limit
+static long budget = -1;
+/**
+ * @brief allocator that throws `std::bad_alloc` once the budget is spent
+ */
+template <typename _Tp> struct budget_allocator {
+    using value_type = _Tp;
+    budget_allocator() = default;
+    template <typename _Up> budget_allocator(const budget_allocator<_Up>&) {}
+    auto allocate(size_t _n) -> _Tp* {
+        if (budget == 0) throw std::bad_alloc();
+        if (budget > 0) --budget;
+        return std::allocator<_Tp>().allocate(_n);
+    }
+    auto deallocate(_Tp* _p, size_t _n) -> void { std::allocator<_Tp>().deallocate(_p, _n); }
+    template <typename _Up> bool operator==(const budget_allocator<_Up>&) const { return true; }
+};
+/**
+ * @brief hash dictionary whose insertions are charged to the budget as well
+ */
+template <typename _Key, typename _Mapped, typename _Hash> struct budget_table : public icy::hash_table<_Key, _Mapped, _Hash> {
+    using base = icy::hash_table<_Key, _Mapped, _Hash>;
+    auto insert(const _Key& _k, _Mapped _m) -> typename base::key_handle {
+        budget_allocator<_Key>().deallocate(budget_allocator<_Key>().allocate(1), 1);
+        return base::insert(_k, _m);
+    }
+};
+struct budget_policy : public icy::disjoint_policy {
+    using compress_policy = icy::compress_none;
+    struct dictionary_policy : public icy::hash_dictionary {
+        template <typename _Key, typename _Mapped, typename _Hash> using type = budget_table<_Key, _Mapped, _Hash>;
+    };
+};
+
+/**
+ * @brief an erased node that cannot be put back stays in the log, which releases it once
+ */
+void out_of_memory() {
+    for (long _b : {0, 1}) {
+        icy::disjoint_set<unsigned, std::hash<unsigned>, budget_allocator<unsigned>, budget_policy> _s;
+        _s.add(0u);
+        for (unsigned _i = 1; _i != 4; ++_i) _s.add(_i, 0u);
+        const auto _c = _s.checkpoint();
+        EXPECT_TRUE(_s.del(1u));
+        EXPECT_TRUE(_s.del(2u));
+        budget = _b;
+        EXPECT_THROW(std::bad_alloc, _s.rollback(_c));
+        budget = -1;
+        EXPECT_EQ(_s.contains(2u), _b == 1);
+        EXPECT_FALSE(_s.contains(1u));
+        EXPECT_NOTHROW(_s.check());
+        _s.commit();
+        EXPECT_EQ(_s.size(), 2 + static_cast<size_t>(_b));
+    }
+}
+
+/**
+ * @brief a random modification, every kind that is logged
+ */
+template <typename _Set, typename _Gen> void mutate(_Set& _s, _Gen& _gen) {
+    std::uniform_int_distribution<unsigned> _key(0, _n - 1);
+    const unsigned _x = _key(_gen), _y = _key(_gen);
+    switch (_gen() % 7) {
+    case 0: _s.add(_x); break;
+    case 1: _s.add(_x, _y); break;
+    case 2: _s.del(_x); break;
+    case 3: _s.join(_x); break;
+    case 4: _s.join(_x, _y); break;
+    case 5: _s.merge(_x, _y); break;
+    default: {
+        std::vector<std::pair<unsigned, unsigned>> _pairs;
+        for (unsigned _i = 0; _i != 12; ++_i) _pairs.emplace_back(_key(_gen), _key(_gen));
+        _s.merge_batch(_pairs);
+    }
+    }
+}
+
+template <typename _Set> void random_rollback() {
+    std::mt19937 _gen(_n);
+    _Set _s;
+    for (unsigned _i = 0; _i != 2000; ++_i) mutate(_s, _gen);
+    for (unsigned _round = 0; _round != 50; ++_round) {
+        const _Set _before = _s;
+        const size_t _classes = _s.classification();
+        auto _c = _s.checkpoint();
+        for (unsigned _i = 0; _i != 100; ++_i) mutate(_s, _gen);
+        EXPECT_NOTHROW(_s.check());
+        // nested checkpoint, undone twice
+        const _Set _middle = _s;
+        auto _d = _s.checkpoint();
+        for (unsigned _i = 0; _i != 100; ++_i) mutate(_s, _gen);
+        _s.rollback(_d);
+        EXPECT_NOTHROW(_s.check());
+        EXPECT_TRUE(_s == _middle);
+        for (unsigned _i = 0; _i != 100; ++_i) mutate(_s, _gen);
+        _s.rollback(_d);
+        EXPECT_TRUE(_s == _middle);
+        _s.rollback(_c);
+        EXPECT_NOTHROW(_s.check());
+        EXPECT_TRUE(_s == _before);
+        EXPECT_EQ(_s.classification(), _classes);
+        // keep some of the rounds
+        for (unsigned _i = 0; _i != 20; ++_i) mutate(_s, _gen);
+        if (_round % 2) {
+            _s.commit();
+            EXPECT_THROW(std::logic_error, _s.rollback(_c));
+        }
+        EXPECT_NOTHROW(_s.check());
+    }
+}
+
+int main(void) {
+    out_of_memory();
+    random_rollback<set_type<pointer_policy>>();
+    random_rollback<set_type<index_policy>>();
+    random_rollback<set_type<pool_policy>>();
+
+    // the class ids survive, the removed headers are restored rather than allocated again
+    set_type<pointer_policy> _s {{1u, 2u}, {3u}};
+    const auto _id = _s.find(1u);
+    auto _c = _s.checkpoint();
+    EXPECT_TRUE(_s.del(1u));
+    EXPECT_TRUE(_s.del(2u));
+    EXPECT_TRUE(_s.merge(3u, 4u) == false);
+    EXPECT_TRUE(_s.add(4u, 3u));
+    EXPECT_EQ(_s.classification(), 1);
+    _s.rollback(_c);
+    EXPECT_EQ(_s.find(1u), _id);
+    EXPECT_EQ(_s.find(2u), _id);
+    EXPECT_FALSE(_s.contains(4u));
+    EXPECT_EQ(_s.classification(), 2);
+    EXPECT_NOTHROW(_s.check());
+    // a bulk deletion commits, so the checkpoint is gone
+    _c = _s.checkpoint();
+    EXPECT_TRUE(_s.del_all(3u));
+    EXPECT_THROW(std::logic_error, _s.rollback(_c));
+    EXPECT_FALSE(_s.contains(3u));
+    // the log moves with the contents
+    _c = _s.checkpoint();
+    EXPECT_TRUE(_s.join(2u));
+    set_type<pointer_policy> _t = std::move(_s);
+    _t.rollback(_c);
+    EXPECT_TRUE(_t.sibling(1u, 2u));
+    EXPECT_NOTHROW(_t.check());
+    // a checkpoint discarded by a rollback stays discarded after the log grows again
+    set_type<pointer_policy> _u;
+    for (unsigned _i = 0; _i != 8; ++_i) _u.add(_i);
+    const auto _c1 = _u.checkpoint();
+    _u.merge(0u, 1u);
+    const auto _c2 = _u.checkpoint();
+    _u.merge(2u, 3u);
+    _u.rollback(_c1);
+    _u.merge(4u, 5u);
+    _u.merge(6u, 7u);
+    EXPECT_THROW(std::logic_error, _u.rollback(_c2));
+    EXPECT_TRUE(_u.sibling(4u, 5u));
+    EXPECT_TRUE(_u.sibling(6u, 7u));
+    _u.rollback(_c1);
+    EXPECT_EQ(_u.classification(), 8);
+
+    // the erased values come back with their nodes
+    map_type _m;
+    _m.add({1u, "one"});
+    _m.add({2u, "two"}, 1u);
+    auto _e = _m.checkpoint();
+    EXPECT_TRUE(_m.del(2u));
+    EXPECT_TRUE(_m.add({3u, "three"}));
+    EXPECT_TRUE(_m.merge(1u, 3u));
+    _m.rollback(_e);
+    EXPECT_EQ(_m.at(2u), "two");
+    EXPECT_FALSE(_m.contains(3u));
+    EXPECT_TRUE(_m.sibling(1u, 2u));
+    EXPECT_NOTHROW(_m.check());
+    // a key inserted by operator[] is removed as well
+    _e = _m.checkpoint();
+    _m[4u] = "four";
+    EXPECT_TRUE(_m.merge(1u, 4u));
+    _m.rollback(_e);
+    EXPECT_EQ(_m.size(), 2);
+    EXPECT_FALSE(_m.contains(4u));
+    EXPECT_EQ(_m.sibling(1u), 2);
+    EXPECT_NOTHROW(_m.check());
+    _m.rollback(_e);
+    EXPECT_EQ(_m.size(), 2);
+    return 0;
+}
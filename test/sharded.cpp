@@ -0,0 +1,106 @@
+#include "main.hpp"
+
+#include "disjoint.hpp"
+
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct flat_policy : public icy::disjoint_policy {
+    using dictionary_policy = icy::flat_dictionary;
+    using storage_policy = icy::index_storage;
+};
+template <typename _Policy> using sharded_type = icy::sharded_disjoint_set<unsigned, std::hash<unsigned>, std::allocator<unsigned>, _Policy>;
+
+/**
+ * @brief writers add and merge at once, the shards and the portals agree with one `disjoint_set`
+ */
+template <typename _Policy> void agree(unsigned _seed, size_t _shards, unsigned _threads) {
+    static constexpr unsigned _keys = 6000, _edges = 5000;
+    std::mt19937 _gen(_seed);
+    std::uniform_int_distribution<unsigned> _key(0, _keys + 100);
+    std::vector<std::pair<unsigned, unsigned>> _e;
+    for (unsigned _i = 0; _i != _edges; ++_i) _e.emplace_back(_key(_gen), _key(_gen));
+    sharded_type<_Policy> _s(_shards);
+    EXPECT_EQ(_s.shards(), _shards);
+    {
+        std::vector<std::jthread> _writers;
+        for (unsigned _t = 0; _t != _threads; ++_t) {
+            _writers.emplace_back([&, _t]() {
+                for (unsigned _i = _t; _i < _keys; _i += _threads) EXPECT_TRUE(_s.add(_i));
+            });
+        }
+    }
+    EXPECT_EQ(_s.size(), _keys);
+    EXPECT_FALSE(_s.add(3u));
+    {
+        std::vector<std::jthread> _writers;
+        for (unsigned _t = 0; _t != _threads; ++_t) {
+            _writers.emplace_back([&, _t]() {
+                for (size_t _i = _t; _i < _e.size(); _i += _threads) {
+                    const auto [_x, _y] = _e[_i];
+                    EXPECT_EQ(_s.merge(_x, _y), _x < _keys && _y < _keys);
+                    if (_x < _keys && _y < _keys) EXPECT_TRUE(_s.sibling(_y, _x));
+                }
+            });
+        }
+    }
+    icy::disjoint_set<unsigned> _expected;
+    for (unsigned _i = 0; _i != _keys; ++_i) _expected.add(_i);
+    for (const auto& [_x, _y] : _e) _expected.merge(_x, _y);
+    EXPECT_EQ(_s.classification(), _expected.classification());
+    for (unsigned _i = 0; _i != 20000; ++_i) {
+        const unsigned _x = _key(_gen) % _keys, _y = (_i % 3 == 0) ? _e[_i % _edges].first : _key(_gen);
+        EXPECT_EQ(_s.sibling(_x, _y), _expected.sibling(_x, _y));
+    }
+}
+
+int main(void) {
+    for (unsigned _seed = 0; _seed != 3; ++_seed) {
+        agree<icy::disjoint_policy>(_seed, 1, 2);
+        agree<icy::disjoint_policy>(_seed, 8, 4);
+        agree<flat_policy>(_seed, 5, 8);
+        agree<icy::dense_policy>(_seed, 16, 3);
+    }
+    // siblings of one shard linked only through another shard
+    icy::sharded_disjoint_set<std::string> _world(3);
+    for (const char* _c : {"ger", "ita", "jap", "eng", "usa", "sov", "chi", "fra"}) EXPECT_TRUE(_world.add(_c));
+    EXPECT_TRUE(_world.merge("ger", "ita"));
+    EXPECT_TRUE(_world.merge("ita", "jap"));
+    EXPECT_TRUE(_world.merge("eng", "usa"));
+    EXPECT_TRUE(_world.merge("usa", "sov"));
+    EXPECT_TRUE(_world.merge("sov", "chi"));
+    EXPECT_TRUE(_world.merge("fra", "eng"));
+    EXPECT_FALSE(_world.merge("fra", "pol"));
+    EXPECT_EQ(_world.classification(), 2);
+    EXPECT_TRUE(_world.sibling("ger", "jap"));
+    EXPECT_TRUE(_world.sibling("chi", "fra"));
+    EXPECT_FALSE(_world.sibling("ger", "fra"));
+    EXPECT_FALSE(_world.sibling("pol", "pol"));
+    EXPECT_TRUE(_world.merge("chi", "jap"));
+    EXPECT_EQ(_world.classification(), 1);
+    EXPECT_TRUE(_world.sibling("ger", "usa"));
+    // the portals are opened and united by many threads at once, across the growing blocks
+    icy::link_forest _links;
+    static constexpr unsigned _chain = 5000;
+    std::vector<std::vector<size_t>> _opened(4);
+    {
+        std::vector<std::jthread> _writers;
+        for (unsigned _t = 0; _t != _opened.size(); ++_t) {
+            _writers.emplace_back([&, _t]() {
+                for (unsigned _i = 0; _i != _chain; ++_i) {
+                    _opened[_t].push_back(_links.open());
+                    if (_i != 0) EXPECT_TRUE(_links.unite(_opened[_t][_i - 1], _opened[_t][_i]));
+                }
+            });
+        }
+    }
+    EXPECT_EQ(_links.size(), _opened.size() * _chain);
+    for (unsigned _t = 0; _t != _opened.size(); ++_t) {
+        EXPECT_TRUE(_links.same(_opened[_t].front(), _opened[_t].back()));
+        EXPECT_EQ(_links.same(_opened[_t].back(), _opened[0].front()), _t == 0);
+    }
+    return 0;
+}
@@ -2,6 +2,7 @@
 
 #include "disjoint.hpp"
 
+#include <filesystem>
 #include <string>
 
 int main(void) {
@@ -170,5 +171,14 @@ int main(void) {
     EXPECT_TRUE(_world.contains("prc"));
     EXPECT_EQ(_world.size(), 26);
     EXPECT_EQ(_world.classification(), 7);
+    /// archive, the world goes to sleep and wakes up unchanged
+    const auto _path = std::filesystem::temp_directory_path() / "icy_world_war2.dsj";
+    _world.save(_path);
+    const icy::disjoint_set<std::string> _woken = icy::disjoint_set<std::string>::load(_path);
+    EXPECT_EQ(_woken, _world);
+    EXPECT_EQ(_woken.classification(), 7);
+    EXPECT_EQ(_woken.sibling("sov"), 7);
+    EXPECT_NOTHROW(_woken.check());
+    std::filesystem::remove(_path);
     return 0;
 }
\ No newline at end of file